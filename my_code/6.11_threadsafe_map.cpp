@@ -2,98 +2,1213 @@
 // Created by chen on 2022/9/1.
 //
 // 采用精细粒度锁操作的map数据结构
+// 键空间被划分为固定数量的分段（Bucket），每个分段一把读写锁；
+// 分段内部是开放寻址（线性探测）的扁平数组，而不是链表，查找时只需顺序扫描控制字节，对缓存友好。
+// 每个分段独立扩容，并且是渐进式的：扩容时旧表不会一次性搬完，而是由后续的写操作每次搬一小批，
+// 因此扩容既不会阻塞其它分段的读写，也不会让本分段的某次写操作停顿太久
+//
+// 乐观读（顺序锁，seqlock）：键和值都是可平凡复制的类型时，get 不加锁，也不写任何共享内存。
+// 写者在修改分段前后各把版本号加一（修改期间为奇数），读者在读之前、读之后各读一次版本号，
+// 两次相同且为偶数说明读到的是一致的数据，否则重试。这样读多写少时不会因为读锁的原子操作在各核之间争抢缓存行。
+// 乐观读者与写者对控制字节和槽位中键、值的并发访问都是 relaxed 原子操作（见 atomic_bytes.h），不构成数据竞争
+//
+// 快照（snapshot / to_map / to_vector）不会同时锁住所有分段：开始快照时登记一个“当前快照”，
+// 之后各分段被分块复制，每块只在共享锁内复制 capture_chunk 个槽位。写者修改一个尚未复制完的分段时，
+// 只把被修改的键及其修改前的值记入该分段的撤销记录（O(1)），复制完成后据此还原出登记那一刻的内容。
+// 因此快照反映的是登记那一刻的状态，而写者最多只会停顿复制一块的时间，与分段的大小无关
+//
+// Hash 与 KeyEqual 都声明了 is_transparent 时，get / erase / visit / compute / upsert 可以直接用其它类型的键查找
+// （例如用 std::string_view 查 std::string 键），不必先构造出 Key。
+// compute / upsert / visit 在分段的锁内就地调用函数，适合计数器这类“读-改-写”操作，只需一次加锁，也不会丢失更新
 
+#include "9.7_threadpool_4/task_group.h"
+#include "atomic_bytes.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
-#include <list>
+#include <iostream>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
 #include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
-template <class Key, class Value, class Hash = std::hash<Key>>
+template <class Key, class Value, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
 class ConcurrentMap{
+    static constexpr bool transparent = requires{
+        typename Hash::is_transparent;
+        typename KeyEqual::is_transparent;
+    };
+
 public:
-    // 桶数默认为19
-    ConcurrentMap(std::size_t n = 19, const Hash &h = Hash{}): buckets_(n), hasher_(h){
-        for(auto &x: buckets_){
-            x.reset(new Bucket);
+    // 分段数默认为19
+    ConcurrentMap(std::size_t n = 19, const Hash &h = Hash{}, const KeyEqual &eq = KeyEqual{}):
+            buckets_(n), hasher_(h), key_eq_(eq){
+        for(std::size_t i = 0; i < n; ++i){
+            buckets_[i].reset(new Bucket(hasher_, key_eq_, i, active_snapshot_));
         }
     }
     ConcurrentMap(const ConcurrentMap&) = delete;
     ConcurrentMap& operator=(const ConcurrentMap&) = delete;
 
-    Value get(const Key &k, const Value &default_value = Value{}){
-        return get_bucket(k).get(k, default_value);
+    Value get(const Key &k, const Value &default_value = Value{}) const{
+        std::size_t const h = hasher_(k);
+        return get_bucket(h).get(k, mix(h), default_value);
     }
 
     void set(const Key &k, const Value &v){
-        get_bucket(k).set(k, v);
+        std::size_t const h = hasher_(k);
+        get_bucket(h).set(k, mix(h), v);
     }
 
     void erase(const Key &k){
-        get_bucket(k).erase(k);
+        std::size_t const h = hasher_(k);
+        get_bucket(h).erase(k, mix(h));
     }
 
-    // ConcurrentMap 到 std::map 的映射，方便使用
-    std::map<Key, Value> to_map() const{
-        std::vector<std::unique_lock<std::shared_mutex>> locks;
+    // 异构查找版本，要求 Hash 与 KeyEqual 都是透明的，且 hasher_(k) 与对应 Key 的哈希值相同
+    template<class K> requires transparent
+    Value get(const K &k, const Value &default_value = Value{}) const{
+        std::size_t const h = hasher_(k);
+        return get_bucket(h).get(k, mix(h), default_value);
+    }
+
+    template<class K> requires transparent
+    void erase(const K &k){
+        std::size_t const h = hasher_(k);
+        get_bucket(h).erase(k, mix(h));
+    }
+
+    // 键存在时在共享锁内调用 f(const Value&)，返回是否找到。f 中不能再访问本 map
+    bool visit(const Key &k, auto f) const{
+        return visit_impl(k, f);
+    }
+
+    template<class K> requires transparent
+    bool visit(const K &k, auto f) const{
+        return visit_impl(k, f);
+    }
+
+    // 在独占锁内调用 f(Value&) 并返回其结果；键不存在时先以 Value{} 作为初值，f 正常返回后才插入。f 中同样不能再访问本 map
+    // 例如计数器：m.compute(k, [](long &v){ ++v; });
+    decltype(auto) compute(const Key &k, auto f){
+        return compute_impl(k, f);
+    }
+
+    template<class K> requires transparent
+    decltype(auto) compute(const K &k, auto f){
+        return compute_impl(k, f);
+    }
+
+    // 键不存在时插入 make() 的结果，存在时在独占锁内调用 update(Value&)。返回是否插入了新元素
+    bool upsert(const Key &k, auto make, auto update){
+        return upsert_impl(k, make, update);
+    }
+
+    template<class K> requires transparent
+    bool upsert(const K &k, auto make, auto update){
+        return upsert_impl(k, make, update);
+    }
+
+    // 批量查找，结果与 keys 一一对应。先按分段分组，每个分段只加一次锁（或做一次乐观读）
+    std::vector<Value> multi_get(std::span<const Key> keys, const Value &default_value = Value{}) const{
+        std::vector<Value> res(keys.size(), default_value);
+        group_by_bucket(keys.size(), [&](std::size_t i){ return hasher_(keys[i]); },
+                        [&](Bucket &b, const batch_entry *first, const batch_entry *last){
+            b.multi_get(keys.data(), first, last, res.data(), default_value);
+        });
+        return res;
+    }
+
+    // 批量写入。同一个键出现多次时，以最后一次为准
+    void multi_set(std::span<const std::pair<Key, Value>> kvs){
+        group_by_bucket(kvs.size(), [&](std::size_t i){ return hasher_(kvs[i].first); },
+                        [&](Bucket &b, const batch_entry *first, const batch_entry *last){
+            b.multi_set(kvs.data(), first, last);
+        });
+    }
+
+    // 元素个数。逐个分段统计，并发修改时只是一个近似值
+    std::size_t size() const{
+        std::size_t res = 0;
         for(auto &x: buckets_){
-            locks.emplace_back(std::unique_lock<std::shared_mutex>(x->m));
+            std::shared_lock<std::shared_mutex> l(x->m);
+            res += x->count;
         }
-        std::map<Key, Value> res;
+        return res;
+    }
+
+    // 某一时刻的一致性快照，按分段保存。生成快照期间写者不会被整体阻塞
+    class Snapshot{
+    public:
+        using value_type = std::pair<Key, Value>;
+
+        class const_iterator{
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<Key, Value>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type*;
+            using reference = const value_type&;
+
+            const_iterator() = default;
+            reference operator*() const{ return (*parts)[part][pos]; }
+            pointer operator->() const{ return &(*parts)[part][pos]; }
+            const_iterator& operator++(){
+                ++pos;
+                skip_empty();
+                return *this;
+            }
+            const_iterator operator++(int){
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            bool operator==(const const_iterator &other) const{
+                return part == other.part && pos == other.pos;
+            }
+
+        private:
+            friend class Snapshot;
+            std::vector<std::vector<value_type>> const *parts = nullptr;
+            std::size_t part = 0;
+            std::size_t pos = 0;
+
+            const_iterator(std::vector<std::vector<value_type>> const *parts_, std::size_t part_):
+                    parts(parts_), part(part_){
+                skip_empty();
+            }
+            void skip_empty(){
+                while(part < parts->size() && pos == (*parts)[part].size()){
+                    ++part;
+                    pos = 0;
+                }
+            }
+        };
+
+        const_iterator begin() const{ return const_iterator(&parts, 0); }
+        const_iterator end() const{ return const_iterator(&parts, parts.size()); }
+
+        std::size_t size() const{
+            std::size_t res = 0;
+            for(auto &x: parts){
+                res += x.size();
+            }
+            return res;
+        }
+
+    private:
+        friend class ConcurrentMap;
+        std::vector<std::vector<value_type>> parts;     // 每个分段一份，无序
+    };
+
+    Snapshot snapshot() const{
+        ActiveSnapshot active(*this);
         for(auto &x: buckets_){
-            for(auto &y: x->data){
-                res.emplace(y);
+            x->capture(active.state);
+        }
+        return active.finish();
+    }
+
+    // 在线程池上并行复制各分段
+    Snapshot snapshot(thread_pool &tp) const{
+        ActiveSnapshot active(*this);
+        {
+            task_group g(tp);
+            for(auto &x: buckets_){
+                Bucket *b = x.get();
+                SnapshotState *state = &active.state;
+                g.spawn([b, state]{
+                    b->capture(*state);
+                });
             }
+            g.wait();
         }
-        return res;
+        return active.finish();
+    }
+
+    // ConcurrentMap 到 std::map 的映射，方便使用
+    // 各分段先各自排序，再做一次多路归并，按序插入 std::map（每次插入都在末尾，均摊常数时间）
+    std::map<Key, Value> to_map() const{
+        Snapshot s = snapshot();
+        for(auto &part: s.parts){
+            std::sort(part.begin(), part.end(), key_less);
+        }
+        return merge_sorted(s);
+    }
+
+    // 并行版本：复制与各分段的排序都在线程池上进行
+    std::map<Key, Value> to_map(thread_pool &tp) const{
+        Snapshot s = snapshot(tp);
+        {
+            task_group g(tp);
+            for(auto &part: s.parts){
+                std::vector<std::pair<Key, Value>> *p = &part;
+                g.spawn([p]{
+                    std::sort(p->begin(), p->end(), key_less);
+                });
+            }
+            g.wait();
+        }
+        return merge_sorted(s);
+    }
+
+    // 所有元素（无序）
+    std::vector<std::pair<Key, Value>> to_vector() const{
+        return flatten(snapshot());
+    }
+
+    std::vector<std::pair<Key, Value>> to_vector(thread_pool &tp) const{
+        return flatten(snapshot(tp));
     }
 
 
 private:
-    // 基于list实现的桶。每个桶带有一个锁
+    // 可平凡复制（且可默认构造）的键值才能被乐观读者按字节拷贝出来再校验，其它类型的 get 使用共享锁
+    static constexpr bool optimistic_reads = std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>
+                                             && std::is_default_constructible_v<Key> && std::is_default_constructible_v<Value>;
+
+    // 乐观读模式下的元素：键和值是两个独立的字段，各自可平凡复制，乐观读者分别原子地拷贝出来。
+    // 不能整体按字节拷贝 std::pair / std::optional，它们本身不是可平凡复制的类型
+    struct flat_entry{
+        Key first;
+        Value second;
+    };
+    using entry_type = std::conditional_t<optimistic_reads, flat_entry, std::pair<Key, Value>>;
+    // 乐观读模式下槽位就是 flat_entry，是否有元素只看控制字节；否则用 optional 管理元素的构造与析构
+    using slot_type = std::conditional_t<optimistic_reads, flat_entry, std::optional<std::pair<Key, Value>>>;
+
+    // 一个分段的复制进度。done 之前的字段只在持有该分段的锁时访问：复制者持有共享锁，写者持有独占锁
+    struct PartCapture{
+        std::vector<std::pair<Key, Value>> copied;      // 当前布局下 [0, cursor) 槽位中的元素
+        std::size_t cursor = 0;     // 下一个要复制的槽位（旧表在前、新表在后连成一个序列）
+        std::uint64_t layout = 0;   // 开始复制时分段的布局版本，不同时已复制的部分作废
+        std::vector<std::pair<Key, std::optional<Value>>> undo;     // 登记之后被修改的键及修改前的值，不存在为空
+        bool done = false;          // 复制完成，写者不再记录
+    };
+
+    // 正在生成的快照：每个分段一份复制进度
+    struct SnapshotState{
+        std::vector<PartCapture> parts;
+
+        explicit SnapshotState(std::size_t n): parts(n){}
+    };
+
+    // 批量操作中的一个元素：在输入中的下标，以及打散后的哈希值
+    struct batch_entry{
+        std::size_t index;
+        std::size_t hash;
+    };
+
+    // 开放寻址表，容量在构造后不再改变。ctrl 为每个槽位的控制字节：
+    //   empty   从未使用过，探测到此即可停止
+    //   deleted 墓碑，探测时需要跳过
+    //   其它    最高位为1，低7位是哈希值的指纹，只有指纹相同才需要比较键
+    // 控制字节总是通过 store_ctrl 原子地写入，乐观读者用 load_ctrl 读取；持有锁的读写可以直接访问
+    struct Table{
+        static constexpr std::uint8_t empty = 0;
+        static constexpr std::uint8_t deleted = 1;
+
+        std::size_t const capacity;
+        std::unique_ptr<std::uint8_t[]> const ctrl;
+        std::unique_ptr<slot_type[]> const slots;
+        std::size_t used = 0;       // 非空槽位数（含墓碑）
+
+        explicit Table(std::size_t capacity_):
+            capacity(capacity_), ctrl(new std::uint8_t[capacity_]()), slots(new slot_type[capacity_]()){}
+
+        static std::uint8_t fingerprint(std::size_t h){
+            return static_cast<std::uint8_t>(0x80 | (h >> 57));
+        }
+
+        // 持有锁时访问第 i 个槽位中的元素，调用前需确认控制字节表示该槽位有元素
+        entry_type& entry(std::size_t i) const{
+            if constexpr(optimistic_reads){
+                return slots[i];
+            }else{
+                return *slots[i];
+            }
+        }
+
+        std::uint8_t load_ctrl(std::size_t i) const{
+            return std::atomic_ref<std::uint8_t>(ctrl[i]).load(std::memory_order_relaxed);
+        }
+
+        void store_ctrl(std::size_t i, std::uint8_t c){
+            std::atomic_ref<std::uint8_t>(ctrl[i]).store(c, std::memory_order_relaxed);
+        }
+
+        // 返回键所在的槽位，不存在时返回 capacity
+        template<class K>
+        std::size_t find(const K &k, std::size_t h, const KeyEqual &eq) const{
+            std::size_t const mask = capacity - 1;
+            std::uint8_t const fp = fingerprint(h);
+            for(std::size_t i = h & mask, probes = 0; probes < capacity; i = (i + 1) & mask, ++probes){
+                if(ctrl[i] == empty){
+                    return capacity;
+                }
+                if(ctrl[i] == fp && eq(entry(i).first, k)){
+                    return i;
+                }
+            }
+            return capacity;
+        }
+
+        // 预取键的起始探测位置，批量操作在真正探测之前先为整组键发出预取，让各次缓存未命中重叠
+        void prefetch(std::size_t h) const{
+            std::size_t const i = h & (capacity - 1);
+            __builtin_prefetch(&ctrl[i]);
+            __builtin_prefetch(&slots[i]);
+        }
+
+        // 乐观读：不加锁地探测，键先原子地拷贝到本地再比较，匹配后再拷贝值。读到的可能是写到一半的数据，由调用者校验版本号
+        template<class K>
+        bool optimistic_find(const K &k, std::size_t h, const KeyEqual &eq, Value &value) const{
+            static_assert(optimistic_reads, "optimistic reads require trivially copyable Key and Value");
+            std::size_t const mask = capacity - 1;
+            std::uint8_t const fp = fingerprint(h);
+            for(std::size_t i = h & mask, probes = 0; probes < capacity; i = (i + 1) & mask, ++probes){
+                std::uint8_t const c = load_ctrl(i);
+                if(c == empty){
+                    return false;
+                }
+                if(c == fp && eq(atomic_load_copy(&slots[i].first), k)){
+                    value = atomic_load_copy(&slots[i].second);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 调用前需保证键不存在且表未满
+        void insert(std::pair<Key, Value> &&kv, std::size_t h){
+            std::size_t const mask = capacity - 1;
+            std::size_t i = h & mask;
+            while(ctrl[i] & 0x80){
+                i = (i + 1) & mask;
+            }
+            if(ctrl[i] == empty){
+                ++used;
+            }
+            if constexpr(optimistic_reads){
+                atomic_store_bytes(&slots[i].first, kv.first);
+                atomic_store_bytes(&slots[i].second, kv.second);
+            }else{
+                slots[i].emplace(std::move(kv));
+            }
+            store_ctrl(i, fingerprint(h));
+        }
+
+        // 可平凡复制时槽位内容不需要析构，留在原处即可：控制字节已经标记为墓碑，之后的插入会整体覆盖它
+        void erase_at(std::size_t i){
+            store_ctrl(i, deleted);
+            if constexpr(!optimistic_reads){
+                slots[i].reset();
+            }
+        }
+    };
+
+    // 一个分段：当前表 table，以及扩容过程中尚未搬完的旧表 old_table
+    // 两个表指针都是原子的，乐观读者不加锁也能读到完整的指针；写者只在持有独占锁时修改它们
     struct Bucket{
-        std::list<std::pair<Key, Value>> data;
+        static constexpr std::size_t initial_capacity = 16;
+        static constexpr std::size_t migrate_batch = 64;    // 每次写操作顺带搬迁的旧表槽位数
+        static constexpr std::size_t capture_chunk = 1024;  // 快照每次持锁复制的槽位数
+
+        std::atomic<Table*> table{nullptr};
+        std::atomic<Table*> old_table{nullptr};
+        // 乐观读者可能仍在读换下来的旧表，所以旧表要保留到分段析构。表容量每次翻倍，保留的内存不超过当前表的大小
+        std::vector<std::unique_ptr<Table>> retired;
+        std::size_t migrate_pos = 0;
+        std::size_t count = 0;      // 元素个数
+        std::atomic<std::uint64_t> version{0};
+        std::uint64_t layout = 0;   // 元素在表中的位置发生变化（搬迁、扩容、原地重建）时加一
+        // 写操作期间若有快照尚未复制完本分段，指向它的撤销记录
+        std::vector<std::pair<Key, std::optional<Value>>> *undo = nullptr;
         mutable std::shared_mutex m;
+        const Hash &hasher;         // 搬迁时需要重新计算哈希值
+        const KeyEqual &key_eq;
+        std::size_t const index;    // 分段号
+        std::atomic<SnapshotState*> &active_snapshot;
 
-        Value get(const Key &k, const Value &default_value) const{
-            std::shared_lock<std::shared_mutex> l(m);   // 读操作，使用共享锁
-            auto it = std::find_if(data.begin(), data.end(), [&](auto &x){
-                return x.first == k;
-            });
-            return it == data.end() ? default_value : it->second;
+        Bucket(const Hash &hasher_, const KeyEqual &key_eq_, std::size_t index_,
+               std::atomic<SnapshotState*> &active_snapshot_):
+                hasher(hasher_), key_eq(key_eq_), index(index_), active_snapshot(active_snapshot_){}
+        ~Bucket(){
+            delete table.load(std::memory_order_relaxed);
+            delete old_table.load(std::memory_order_relaxed);
         }
 
-        void set(const Key &k, const Value &v){
-            std::unique_lock<std::shared_mutex> l(m);   // 写操作，使用独占锁
-            auto it = std::find_if(data.begin(), data.end(), [&](auto &x){
-                return x.first == k;
-            });
-            if(it == data.end()){
-                data.template emplace_back(k, v);
+        // 写操作的守卫：持有独占锁，并在修改期间把版本号置为奇数
+        class write_guard{
+        public:
+            explicit write_guard(Bucket &b_): b(b_), l(b_.m){
+                // 有快照正在进行且本分段还没复制完时，本次修改的键及修改前的值要记入快照的撤销记录
+                if(SnapshotState *s = b.active_snapshot.load(std::memory_order_seq_cst)){
+                    PartCapture &part = s->parts[b.index];
+                    if(!part.done){
+                        b.undo = &part.undo;
+                    }
+                }
+                b.version.store(b.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+            }
+            ~write_guard(){
+                b.undo = nullptr;
+                b.version.store(b.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+        private:
+            Bucket &b;
+            std::unique_lock<std::shared_mutex> l;
+        };
+
+        template<class K>
+        Value get(const K &k, std::size_t h, const Value &default_value) const{
+            if constexpr(optimistic_reads){
+                for(;;){
+                    std::uint64_t const v1 = version.load(std::memory_order_acquire);
+                    if(v1 & 1){     // 写者正在修改
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    Value res;
+                    Table const *t = table.load(std::memory_order_acquire);
+                    Table const *old = old_table.load(std::memory_order_acquire);
+                    bool const found = (t && t->optimistic_find(k, h, key_eq, res)) ||
+                                       (old && old->optimistic_find(k, h, key_eq, res));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(version.load(std::memory_order_relaxed) == v1){
+                        return found ? res : default_value;
+                    }
+                }
+            }else{
+                std::shared_lock<std::shared_mutex> l(m);   // 读操作，使用共享锁
+                if(const entry_type *p = find(k, h)){
+                    return p->second;
+                }
+                return default_value;
+            }
+        }
+
+        void multi_get(const Key *keys, const batch_entry *first, const batch_entry *last,
+                       Value *out, const Value &default_value) const{
+            if constexpr(optimistic_reads){
+                for(;;){
+                    std::uint64_t const v1 = version.load(std::memory_order_acquire);
+                    if(v1 & 1){
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    Table const *t = table.load(std::memory_order_acquire);
+                    Table const *old = old_table.load(std::memory_order_acquire);
+                    if(t){
+                        for(const batch_entry *e = first; e != last; ++e){
+                            t->prefetch(e->hash);
+                        }
+                    }
+                    for(const batch_entry *e = first; e != last; ++e){
+                        Value res;
+                        bool const found = (t && t->optimistic_find(keys[e->index], e->hash, key_eq, res)) ||
+                                           (old && old->optimistic_find(keys[e->index], e->hash, key_eq, res));
+                        out[e->index] = found ? res : default_value;
+                    }
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(version.load(std::memory_order_relaxed) == v1){
+                        return;
+                    }
+                }
             }else{
-                it->second = v;
+                std::shared_lock<std::shared_mutex> l(m);
+                prefetch_all(first, last);
+                for(const batch_entry *e = first; e != last; ++e){
+                    if(const entry_type *p = find(keys[e->index], e->hash)){
+                        out[e->index] = p->second;
+                    }
+                }
+            }
+        }
+
+        void set(const Key &k, std::size_t h, const Value &v){
+            write_guard g(*this);   // 写操作，使用独占锁
+            assign(k, h, v);
+        }
+
+        void multi_set(const std::pair<Key, Value> *kvs, const batch_entry *first, const batch_entry *last){
+            write_guard g(*this);
+            prefetch_all(first, last);
+            for(const batch_entry *e = first; e != last; ++e){
+                assign(kvs[e->index].first, e->hash, kvs[e->index].second);
+            }
+        }
+
+        template<class K>
+        void erase(const K &k, std::size_t h){
+            write_guard g(*this);   // 写，用独占锁
+            for(Table *t: {current(), old()}){
+                if(!t){
+                    continue;
+                }
+                std::size_t const i = t->find(k, h, key_eq);
+                if(i != t->capacity){
+                    if(undo){
+                        undo->emplace_back(t->entry(i).first, t->entry(i).second);
+                    }
+                    t->erase_at(i);
+                    --count;
+                    break;
+                }
+            }
+            migrate_some();
+        }
+
+        template<class K, class Function>
+        bool visit(const K &k, std::size_t h, Function &f) const{
+            std::shared_lock<std::shared_mutex> l(m);
+            if(const entry_type *p = find(k, h)){
+                f(static_cast<const Value&>(p->second));
+                return true;
+            }
+            return false;
+        }
+
+        template<class K, class Function>
+        decltype(auto) compute(const K &k, std::size_t h, Function &f){
+            write_guard g(*this);
+            if(entry_type *p = find(k, h)){
+                return modify(*p, f);
+            }
+            Value v{};
+            if constexpr(std::is_void_v<std::invoke_result_t<Function&, Value&>>){
+                f(v);
+                insert_new(Key(k), h, std::move(v));
+            }else{
+                std::invoke_result_t<Function&, Value&> res = f(v);
+                insert_new(Key(k), h, std::move(v));
+                return res;
+            }
+        }
+
+        template<class K, class Make, class Update>
+        bool upsert(const K &k, std::size_t h, Make &make, Update &update){
+            write_guard g(*this);
+            if(entry_type *p = find(k, h)){
+                modify(*p, update);
+                return false;
+            }
+            insert_new(Key(k), h, Value(make()));
+            return true;
+        }
+
+        // 分块复制本分段：每块持有共享锁复制 capture_chunk 个槽位，两块之间写者可以继续修改并记录撤销。
+        // 搬迁、扩容会移动元素的位置，使已复制的部分可能遗漏或重复，此时从头重新复制；撤销记录与位置无关，仍然有效
+        void capture(SnapshotState &s) const{
+            PartCapture &part = s.parts[index];
+            std::vector<std::pair<Key, Value>> chunk;      // 锁内只写入这个容量固定的缓冲区，追加到 copied（可能重新分配）在锁外进行
+            chunk.reserve(capture_chunk);
+            for(bool done = false; !done;){
+                {
+                    std::shared_lock<std::shared_mutex> l(m);
+                    if(part.layout != layout){
+                        part.copied.clear();
+                        part.cursor = 0;
+                        part.layout = layout;
+                    }
+                    Table const *old_t = old(), *t = current();
+                    std::size_t const old_capacity = old_t ? old_t->capacity : 0;
+                    std::size_t const total = old_capacity + (t ? t->capacity : 0);
+                    std::size_t const end = std::min(part.cursor + capture_chunk, total);
+                    for(std::size_t pos = part.cursor; pos < end; ++pos){
+                        Table const &src = pos < old_capacity ? *old_t : *t;
+                        std::size_t const i = pos < old_capacity ? pos : pos - old_capacity;
+                        if(src.ctrl[i] & 0x80){
+                            chunk.emplace_back(src.entry(i).first, src.entry(i).second);
+                        }
+                    }
+                    part.cursor = end;
+                    part.done = done = end == total;
+                }
+                // 只有本线程访问 copied：写者只会追加撤销记录
+                part.copied.insert(part.copied.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+                chunk.clear();
             }
+            apply_undo(part);
         }
 
-        void erase(const Key &k){
-            std::unique_lock<std::shared_mutex> l(m);   // 写，用独占锁
-            auto it = std::find_if(data.begin(), data.end(), [&](auto &x){
-                return x.first == k;
+        // 用撤销记录把复制到的内容还原为登记时刻的状态：被修改过的键以第一条记录（修改前的值）为准
+        void apply_undo(PartCapture &part) const{
+            if(part.undo.empty()){
+                return;
+            }
+            std::unordered_map<Key, std::optional<Value>, Hash, KeyEqual> original(part.undo.size(), hasher, key_eq);
+            for(auto &e: part.undo){
+                original.try_emplace(std::move(e.first), std::move(e.second));
+            }
+            std::erase_if(part.copied, [&](const std::pair<Key, Value> &kv){
+                return original.count(kv.first) != 0;
             });
-            if(it != data.end()){
-                data.erase(it);
+            for(auto &e: original){
+                if(e.second){
+                    part.copied.emplace_back(e.first, std::move(*e.second));
+                }
+            }
+            part.undo.clear();
+        }
+
+        // 以下函数要求调用者已持有锁
+        void assign(const Key &k, std::size_t h, const Value &v){
+            if(entry_type *p = find(k, h)){
+                modify(*p, [&v](Value &x){ x = v; });
+                return;
+            }
+            insert_new(Key(k), h, Value(v));
+        }
+
+        // 就地修改已有元素的值。乐观读模式下读者可能正在读这个值，因此先在副本上调用 f，再原子地写回
+        template<class Function>
+        decltype(auto) modify(entry_type &kv, Function &&f){
+            if(undo){
+                undo->emplace_back(kv.first, kv.second);
+            }
+            if constexpr(optimistic_reads){
+                Value v = kv.second;
+                if constexpr(std::is_void_v<std::invoke_result_t<Function&, Value&>>){
+                    f(v);
+                    atomic_store_bytes(&kv.second, v);
+                }else{
+                    std::invoke_result_t<Function&, Value&> res = f(v);
+                    atomic_store_bytes(&kv.second, v);
+                    return res;
+                }
+            }else{
+                return f(kv.second);
+            }
+        }
+
+        // 调用前需保证键不存在
+        void insert_new(Key &&k, std::size_t h, Value &&v){
+            if(undo){
+                undo->emplace_back(k, std::nullopt);
+            }
+            reserve_one();
+            current()->insert(std::pair<Key, Value>(std::move(k), std::move(v)), h);
+            ++count;
+        }
+
+        void prefetch_all(const batch_entry *first, const batch_entry *last) const{
+            if(Table const *t = current()){
+                for(const batch_entry *e = first; e != last; ++e){
+                    t->prefetch(e->hash);
+                }
+            }
+        }
+
+        Table* current() const{
+            return table.load(std::memory_order_relaxed);
+        }
+
+        Table* old() const{
+            return old_table.load(std::memory_order_relaxed);
+        }
+
+        // 新表优先；扩容期间键可能还留在旧表中
+        template<class K>
+        entry_type* find(const K &k, std::size_t h) const{
+            for(Table *t: {current(), old()}){
+                if(t){
+                    std::size_t const i = t->find(k, h, key_eq);
+                    if(i != t->capacity){
+                        return &t->entry(i);
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        // 为插入一个新元素腾出空间：负载因子超过 7/8 时开始扩容
+        void reserve_one(){
+            migrate_some();
+            Table *t = current();
+            if(!t){
+                table.store(new Table(initial_capacity), std::memory_order_release);
+                ++layout;
+                return;
+            }
+            if((t->used + 1) * 8 <= t->capacity * 7){
+                return;
+            }
+            finish_migration();     // 上一次扩容尚未完成，先搬完（很少发生）
+            if((count + 1) * 2 <= t->capacity){
+                rebuild_in_place(*t);   // 主要是墓碑，原地清理即可
+                return;
+            }
+            old_table.store(t, std::memory_order_release);
+            table.store(new Table(t->capacity * 2), std::memory_order_release);
+            ++layout;
+            migrate_pos = 0;
+            migrate_some();
+        }
+
+        void migrate_some(){
+            Table *old_t = old();
+            if(!old_t){
+                return;
+            }
+            ++layout;
+            Table *t = current();
+            std::size_t const end = std::min(migrate_pos + migrate_batch, old_t->capacity);
+            for(; migrate_pos < end; ++migrate_pos){
+                if(old_t->ctrl[migrate_pos] & 0x80){
+                    entry_type &kv = old_t->entry(migrate_pos);
+                    std::size_t const h = mix(hasher(kv.first));
+                    t->insert(std::pair<Key, Value>(std::move(kv.first), std::move(kv.second)), h);
+                    old_t->erase_at(migrate_pos);
+                }
+            }
+            if(migrate_pos == old_t->capacity){
+                old_table.store(nullptr, std::memory_order_release);
+                retire(old_t);
+                migrate_pos = 0;
+            }
+        }
+
+        void finish_migration(){
+            while(old()){
+                migrate_some();
+            }
+        }
+
+        // 原地重建（清除墓碑），表的内存不变，乐观读者会因版本号变化而重试
+        void rebuild_in_place(Table &t){
+            ++layout;
+            std::vector<std::pair<Key, Value>> entries;
+            entries.reserve(count);
+            for(std::size_t i = 0; i < t.capacity; ++i){
+                if(t.ctrl[i] & 0x80){
+                    entries.emplace_back(std::move(t.entry(i).first), std::move(t.entry(i).second));
+                    t.erase_at(i);
+                }
+                t.store_ctrl(i, Table::empty);
+            }
+            t.used = 0;
+            for(auto &kv: entries){
+                std::size_t const h = mix(hasher(kv.first));
+                t.insert(std::move(kv), h);
+            }
+        }
+
+        void retire(Table *t){
+            if constexpr(optimistic_reads){
+                retired.emplace_back(t);
+            }else{
+                delete t;
             }
         }
     };
 
+    // 同一时刻只有一个快照在进行。登记与检查都是 seq_cst：在登记之前检查过的写操作都包含在快照中，之后的都不包含
+    mutable std::atomic<SnapshotState*> active_snapshot_{nullptr};
+    mutable std::mutex snapshot_mutex_;
     std::vector<std::unique_ptr<Bucket>> buckets_;
     Hash hasher_;
+    KeyEqual key_eq_;
+
+    // 登记/注销当前快照。注销后逐个分段加锁再释放一次，确保仍看到旧指针的写者都已离开，之后才能移走副本
+    struct ActiveSnapshot{
+        ConcurrentMap const &map;
+        std::lock_guard<std::mutex> l;
+        SnapshotState state;
+        bool active = true;
+
+        explicit ActiveSnapshot(ConcurrentMap const &map_):
+                map(map_), l(map_.snapshot_mutex_), state(map_.buckets_.size()){
+            map.active_snapshot_.store(&state, std::memory_order_seq_cst);
+        }
+        ~ActiveSnapshot(){
+            deactivate();
+        }
+
+        void deactivate(){
+            if(active){
+                map.active_snapshot_.store(nullptr, std::memory_order_seq_cst);
+                for(auto &x: map.buckets_){
+                    std::shared_lock<std::shared_mutex> wait_writers(x->m);
+                }
+                active = false;
+            }
+        }
+
+        Snapshot finish(){
+            deactivate();
+            Snapshot res;
+            res.parts.reserve(state.parts.size());
+            for(auto &part: state.parts){
+                res.parts.push_back(std::move(part.copied));
+            }
+            return res;
+        }
+    };
+
+    static bool key_less(const std::pair<Key, Value> &a, const std::pair<Key, Value> &b){
+        return std::less<Key>{}(a.first, b.first);
+    }
+
+    // 各分段已按键排好序
+    static std::map<Key, Value> merge_sorted(Snapshot &s){
+        using cursor = std::pair<std::size_t, std::size_t>;     // (分段号, 位置)
+        auto const cursor_greater = [&s](const cursor &a, const cursor &b){
+            return key_less(s.parts[b.first][b.second], s.parts[a.first][a.second]);
+        };
+        std::priority_queue<cursor, std::vector<cursor>, decltype(cursor_greater)> heap(cursor_greater);
+        for(std::size_t i = 0; i < s.parts.size(); ++i){
+            if(!s.parts[i].empty()){
+                heap.emplace(i, 0);
+            }
+        }
+        std::map<Key, Value> res;
+        while(!heap.empty()){
+            cursor c = heap.top();
+            heap.pop();
+            res.emplace_hint(res.end(), std::move(s.parts[c.first][c.second]));
+            if(++c.second < s.parts[c.first].size()){
+                heap.push(c);
+            }
+        }
+        return res;
+    }
+
+    static std::vector<std::pair<Key, Value>> flatten(Snapshot s){
+        std::vector<std::pair<Key, Value>> res;
+        res.reserve(s.size());
+        for(auto &part: s.parts){
+            std::move(part.begin(), part.end(), std::back_inserter(res));
+        }
+        return res;
+    }
+
+    // 分段号直接取 hash % n，分段内的槽位号与指纹则取打散后的哈希值（splitmix64），
+    // 避免 std::hash<int> 这类恒等哈希在线性探测中产生聚集
+    static std::size_t mix(std::size_t h){
+        std::uint64_t x = h;
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return static_cast<std::size_t>(x);
+    }
+
+    Bucket& get_bucket(std::size_t h) const{
+        return *buckets_[h % buckets_.size()];
+    }
+
+    template<class K, class Function>
+    bool visit_impl(const K &k, Function &f) const{
+        std::size_t const h = hasher_(k);
+        return get_bucket(h).visit(k, mix(h), f);
+    }
+
+    template<class K, class Function>
+    decltype(auto) compute_impl(const K &k, Function &f){
+        std::size_t const h = hasher_(k);
+        return get_bucket(h).compute(k, mix(h), f);
+    }
+
+    template<class K, class Make, class Update>
+    bool upsert_impl(const K &k, Make &make, Update &update){
+        std::size_t const h = hasher_(k);
+        return get_bucket(h).upsert(k, mix(h), make, update);
+    }
 
-    Bucket& get_bucket(const Key &k) const{
-        return *buckets_[hasher_(k) % buckets_.size()];
+    // 计算 n 个元素的哈希值，按分段号做一次计数排序（保持输入中的相对顺序），再对每个非空的分组调用 f(分段, 分组)
+    template<class HashAt, class Function>
+    void group_by_bucket(std::size_t n, HashAt hash_at, Function f) const{
+        std::size_t const bucket_count = buckets_.size();
+        std::vector<std::size_t> hashes(n);
+        std::vector<std::size_t> offsets(bucket_count + 1, 0);
+        for(std::size_t i = 0; i < n; ++i){
+            hashes[i] = hash_at(i);
+            ++offsets[hashes[i] % bucket_count + 1];
+        }
+        for(std::size_t b = 0; b < bucket_count; ++b){
+            offsets[b + 1] += offsets[b];
+        }
+        std::vector<batch_entry> entries(n);
+        std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+        for(std::size_t i = 0; i < n; ++i){
+            entries[pos[hashes[i] % bucket_count]++] = batch_entry{i, mix(hashes[i])};
+        }
+        for(std::size_t b = 0; b < bucket_count; ++b){
+            if(offsets[b] != offsets[b + 1]){
+                f(*buckets_[b], entries.data() + offsets[b], entries.data() + offsets[b + 1]);
+            }
+        }
     }
-};
\ No newline at end of file
+};
+
+// 查找吞吐量随键数量的变化：键数从 1e3 增长到 1e7（传入参数 8 可以测到 1e8，需要数GB内存）
+void bench_key_count(int max_exponent){
+    using namespace std::chrono;
+    std::mt19937_64 engine(42);
+
+    for(int e = 3; e <= max_exponent; ++e){
+        std::size_t n = 1;
+        for(int i = 0; i < e; ++i){
+            n *= 10;
+        }
+        ConcurrentMap<std::uint64_t, std::uint64_t> m;
+        auto const start_insert = steady_clock::now();
+        for(std::uint64_t i = 0; i < n; ++i){
+            m.set(i * 7919, i);
+        }
+        auto const insert_ms = duration_cast<milliseconds>(steady_clock::now() - start_insert).count();
+
+        std::size_t const lookups = 10000000;
+        std::uniform_int_distribution<std::uint64_t> dist(0, n - 1);
+        std::uint64_t sum = 0, expected = 0;
+        auto const start = steady_clock::now();
+        for(std::size_t i = 0; i < lookups; ++i){
+            std::uint64_t const k = dist(engine);
+            sum += m.get(k * 7919);
+            expected += k;
+        }
+        auto const us = duration_cast<microseconds>(steady_clock::now() - start).count();
+        std::cout << "keys = 1e" << e << ": insert " << insert_ms << " ms, lookup "
+                  << (us ? double(lookups) / us : 0.0) << " M ops/s"
+                  << (sum == expected && m.size() == n ? "  check." : "  MISMATCH") << std::endl;
+    }
+}
+
+// 读多写少（>99% get）时读吞吐量随读线程数的变化
+void bench_read_mostly(){
+    using namespace std::chrono;
+    std::size_t const n = 100000;
+    ConcurrentMap<std::uint64_t, std::uint64_t> m;
+    for(std::uint64_t i = 0; i < n; ++i){
+        m.set(i, i);
+    }
+    unsigned const max_readers = std::max(4u, std::thread::hardware_concurrency());
+    for(unsigned readers = 1; readers <= max_readers; readers *= 2){
+        std::atomic<bool> stop(false);
+        std::atomic<bool> ok(true);
+        std::thread writer([&]{     // 一个写线程不断修改值，但保持 value == key
+            std::mt19937_64 engine(7);
+            while(!stop){
+                std::uint64_t const k = engine() % n;
+                m.set(k, k);
+                std::this_thread::sleep_for(microseconds(100));
+            }
+        });
+        std::vector<std::thread> threads;
+        std::atomic<std::uint64_t> total(0);
+        std::size_t const lookups = 2000000;
+        auto const start = steady_clock::now();
+        for(unsigned r = 0; r < readers; ++r){
+            threads.emplace_back([&, r]{
+                std::mt19937_64 engine(r);
+                for(std::size_t i = 0; i < lookups; ++i){
+                    std::uint64_t const k = engine() % n;
+                    if(m.get(k, n) != k){
+                        ok = false;
+                    }
+                }
+                total += lookups;
+            });
+        }
+        for(auto &t: threads){
+            t.join();
+        }
+        auto const us = duration_cast<microseconds>(steady_clock::now() - start).count();
+        stop = true;
+        writer.join();
+        std::cout << "readers = " << readers << ": " << (us ? double(total) / us : 0.0) << " M gets/s"
+                  << (ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+}
+
+// 生成快照 / to_map 的耗时，以及期间写者单次 set 的最长停顿
+void bench_snapshot(){
+    using namespace std::chrono;
+    std::size_t const n = 1000000;
+    ConcurrentMap<std::uint64_t, std::uint64_t> m;
+    for(std::uint64_t i = 0; i < n; ++i){
+        m.set(i, i);
+    }
+    thread_pool tp;
+    bool const same = m.to_map() == m.to_map(tp) && m.to_vector(tp).size() == n;
+
+    auto run = [&](const char *name, auto &&copy){
+        std::atomic<bool> stop(false);
+        std::atomic<long long> max_stall_us(0);
+        std::thread writer([&]{     // 只修改已有键的值，元素个数保持为 n
+            std::mt19937_64 engine(3);
+            while(!stop){
+                std::uint64_t const k = engine() % n;
+                auto const start = steady_clock::now();
+                m.set(k, k + 1);
+                long long const us = duration_cast<microseconds>(steady_clock::now() - start).count();
+                if(us > max_stall_us){
+                    max_stall_us = us;
+                }
+            }
+        });
+        bool ok = true;
+        auto const start = steady_clock::now();
+        for(int i = 0; i < 5; ++i){
+            ok = ok && copy() == n;
+        }
+        auto const ms = duration_cast<milliseconds>(steady_clock::now() - start).count() / 5;
+        stop = true;
+        writer.join();
+        std::cout << name << ": " << ms << " ms per copy, max writer stall " << max_stall_us << " us"
+                  << (ok ? "  check." : "  MISMATCH") << std::endl;
+    };
+    run("snapshot()     ", [&]{ return m.snapshot().size(); });
+    run("snapshot(pool) ", [&]{ return m.snapshot(tp).size(); });
+    run("to_map()       ", [&]{ return m.to_map().size(); });
+    run("to_map(pool)   ", [&]{ return m.to_map(tp).size(); });
+    std::cout << "to_map() == to_map(pool): " << (same ? "check." : "MISMATCH") << std::endl;
+
+    // 快照期间另一个线程不断插入、删除新键（触发扩容、搬迁与原地重建）：
+    // 原有的 n 个键从未被修改，每个快照中都必须恰好出现一次且值不变，新键也不能重复
+    {
+        ConcurrentMap<std::uint64_t, std::uint64_t> churn;
+        for(std::uint64_t i = 0; i < n; ++i){
+            churn.set(i, i);
+        }
+        std::atomic<bool> stop(false);
+        std::thread writer([&]{
+            for(std::uint64_t next = n; !stop; ++next){
+                churn.set(next, next);
+                if(next >= n + 1000){
+                    churn.erase(next - 1000);
+                }
+            }
+        });
+        bool ok = true;
+        for(int i = 0; i < 10; ++i){
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> v = i % 2 ? churn.to_vector(tp) : churn.to_vector();
+            std::sort(v.begin(), v.end());
+            ok = ok && v.size() >= n && std::adjacent_find(v.begin(), v.end(), [](auto &a, auto &b){
+                return a.first == b.first;
+            }) == v.end();
+            for(std::uint64_t k = 0; ok && k < n; ++k){
+                ok = v[k].first == k && v[k].second == k;
+            }
+        }
+        stop = true;
+        writer.join();
+        std::cout << "snapshots under insert/erase churn: " << (ok ? "check." : "MISMATCH") << std::endl;
+    }
+}
+
+// 每批 512 个键：逐个 get 与 multi_get 的对比
+void bench_multi_get(){
+    using namespace std::chrono;
+    std::size_t const n = 1000000, batch = 512, rounds = 20000;
+    ConcurrentMap<std::uint64_t, std::uint64_t> m;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> kvs;
+    for(std::uint64_t i = 0; i < n; ++i){
+        kvs.emplace_back(i * 7919, i);
+    }
+    for(std::size_t i = 0; i < n; i += batch){
+        m.multi_set(std::span<const std::pair<std::uint64_t, std::uint64_t>>(kvs).subspan(i, std::min(batch, n - i)));
+    }
+    std::mt19937_64 engine(11);
+    std::vector<std::uint64_t> keys(batch);
+    std::uint64_t expected = 0, sum_single = 0, sum_multi = 0;
+    microseconds single(0), multi(0);
+    for(std::size_t r = 0; r < rounds; ++r){
+        for(auto &k: keys){
+            std::uint64_t const i = engine() % (n + n / 10);    // 约 9% 的键不存在
+            k = i * 7919;
+            expected += i < n ? i : n;
+        }
+        auto const t0 = steady_clock::now();
+        for(auto k: keys){
+            sum_single += m.get(k, n);
+        }
+        auto const t1 = steady_clock::now();
+        for(auto v: m.multi_get(keys, n)){
+            sum_multi += v;
+        }
+        auto const t2 = steady_clock::now();
+        single += duration_cast<microseconds>(t1 - t0);
+        multi += duration_cast<microseconds>(t2 - t1);
+    }
+    double const total = double(batch * rounds);
+    std::cout << "get x" << batch << ": " << total / single.count() << " M keys/s, multi_get: "
+              << total / multi.count() << " M keys/s"
+              << (sum_single == expected && sum_multi == expected && m.size() == n ? "  check." : "  MISMATCH") << std::endl;
+}
+
+// 透明哈希：std::string 键可以直接用 std::string_view 查找
+struct string_hash{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const{
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+// 多线程计数器：get + set（两次加锁，会丢失更新）与 compute（一次加锁）对比
+void bench_counters(){
+    using namespace std::chrono;
+    ConcurrentMap<std::string, long, string_hash, std::equal_to<>> m;
+    std::vector<std::string> names;
+    for(int i = 0; i < 64; ++i){
+        names.push_back("counter_" + std::to_string(i));
+    }
+    unsigned const threads_count = 4;
+    long const increments = 200000;
+
+    auto run = [&](const char *name, auto &&increment){
+        for(auto &x: names){
+            m.set(x, 0);
+        }
+        std::vector<std::thread> threads;
+        auto const start = steady_clock::now();
+        for(unsigned t = 0; t < threads_count; ++t){
+            threads.emplace_back([&, t]{
+                for(long i = 0; i < increments; ++i){
+                    increment(std::string_view(names[(i + t) % names.size()]));
+                }
+            });
+        }
+        for(auto &t: threads){
+            t.join();
+        }
+        auto const ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+        long total = 0;
+        for(auto &x: names){
+            m.visit(std::string_view(x), [&](const long &v){ total += v; });
+        }
+        std::cout << name << ": " << ms << " ms, total " << total << " / " << threads_count * increments
+                  << (total == threads_count * increments ? "  check." : "  (lost updates)") << std::endl;
+    };
+    run("get + set", [&](std::string_view k){ m.set(std::string(k), m.get(k) + 1); });
+    run("compute  ", [&](std::string_view k){ m.compute(k, [](long &v){ ++v; }); });
+    run("upsert   ", [&](std::string_view k){ m.upsert(k, []{ return 1L; }, [](long &v){ ++v; }); });
+}
+
+int main(int argc, char *argv[]){
+    bench_key_count(argc > 1 ? std::atoi(argv[1]) : 7);
+    bench_read_mostly();
+    bench_snapshot();
+    bench_multi_get();
+    bench_counters();
+    return 0;
+}
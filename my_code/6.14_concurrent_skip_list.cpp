@@ -0,0 +1,128 @@
+//
+// Created by chen on 2026/10/18.
+//
+// ConcurrentSkipList 的正确性检查与性能测试
+// 1. 多个线程并发插入/删除互不重叠的键，最后检查内容与有序性
+// 2. 读多写少（90% find，5% insert，5% erase）下与 ConcurrentList 的吞吐量对比；
+//    ConcurrentList 的查找是 O(n) 的手递手加锁遍历，所以只用较少的键
+
+#include "6.13_threadsafe_list.h"
+#include "6.14_concurrent_skip_list.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+bool check_correctness(){
+    ConcurrentSkipList<int, int> list;
+    int const thread_count = 4, per_thread = 20000;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < thread_count; ++t){
+        threads.emplace_back([&, t]{
+            for(int i = 0; i < per_thread; ++i){
+                int const k = i * thread_count + t;
+                list.insert(k, k * 2);
+            }
+            for(int i = 0; i < per_thread; i += 2){     // 删掉一半
+                list.erase(i * thread_count + t);
+            }
+            for(int i = 0; i < per_thread; ++i){
+                int const k = i * thread_count + t;
+                std::optional<int> v = list.find(k);
+                if(v.has_value() != (i % 2 == 1) || (v && *v != k * 2)){
+                    std::cout << "find mismatch at " << k << std::endl;
+                }
+            }
+        });
+    }
+    for(auto &t: threads){
+        t.join();
+    }
+    int prev = -1, count = 0;
+    bool ok = true;
+    list.for_each([&](const std::pair<const int, int> &kv){
+        ok = ok && kv.first > prev && (kv.first / thread_count) % 2 == 1 && kv.second == kv.first * 2;
+        prev = kv.first;
+        ++count;
+    });
+    int range_count = 0;
+    list.for_each(1000, 2000, [&](const std::pair<const int, int> &kv){
+        ok = ok && kv.first >= 1000 && kv.first < 2000;
+        ++range_count;
+    });
+    auto it = list.lower_bound(1001);
+    ok = ok && count == thread_count * per_thread / 2 && list.size() == std::size_t(count)
+         && range_count == 500 && it != list.end() && it->first == 1004;
+    std::cout << "correctness: " << count << " keys" << (ok ? "  check." : "  MISMATCH") << std::endl;
+    return ok;
+}
+
+// 每个线程执行 ops 次随机操作：90% 查找，5% 插入，5% 删除
+template<class Map>
+double run(Map &map, int thread_count, int key_range, int ops){
+    std::vector<std::thread> threads;
+    auto const start = std::chrono::steady_clock::now();
+    for(int t = 0; t < thread_count; ++t){
+        threads.emplace_back([&, t]{
+            std::mt19937 engine(t + 1);
+            std::uniform_int_distribution<int> key(0, key_range - 1), op(0, 99);
+            for(int i = 0; i < ops; ++i){
+                int const k = key(engine), o = op(engine);
+                if(o < 90){
+                    map.find(k);
+                }else if(o < 95){
+                    map.insert(k, k);
+                }else{
+                    map.erase(k);
+                }
+            }
+        });
+    }
+    for(auto &t: threads){
+        t.join();
+    }
+    auto const us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return us ? double(thread_count) * ops / us : 0.0;
+}
+
+// 把 ConcurrentList 包装成同样的接口（插入不检查重复）
+struct list_adapter{
+    ConcurrentList<int> list;
+    void find(int k){
+        list.find_first_if([k](int x){ return x == k; });
+    }
+    void insert(int k, int){
+        list.push_front(k);
+    }
+    void erase(int k){
+        list.remove_if([k](int x){ return x == k; });
+    }
+};
+
+int main(){
+    if(!check_correctness()){
+        return 1;
+    }
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    for(int key_range: {1000, 1000000}){
+        for(unsigned threads = 1; threads <= max_threads; threads *= 2){
+            ConcurrentSkipList<int, int> skip_list;
+            for(int k = 0; k < key_range; k += 2){
+                skip_list.insert(k, k);
+            }
+            std::cout << "keys = " << key_range << ", threads = " << threads << ": skip list "
+                      << run(skip_list, threads, key_range, 200000) << " M ops/s";
+            if(key_range <= 1000){
+                list_adapter list;
+                for(int k = 0; k < key_range; k += 2){
+                    list.insert(k, k);
+                }
+                std::cout << ", ConcurrentList " << run(list, threads, key_range, 20000) << " M ops/s";
+            }
+            std::cout << std::endl;
+        }
+    }
+    return 0;
+}
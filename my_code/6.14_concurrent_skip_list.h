@@ -0,0 +1,375 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 无锁的有序并发跳表（Herlihy & Shavit 的 LockFreeSkipList）
+// - 每一层都是一个 Harris 风格的无锁链表：删除时先在节点的 next 指针最低位打上标记（逻辑删除），
+//   之后再由遍历经过的线程用CAS把它从前驱上摘下（物理删除）
+// - 第0层的标记决定节点是否存在；insert / erase / find 的期望复杂度为 O(log n)，find 与迭代不做任何写操作
+// - 内存回收使用纪元回收（7.14_epoch_reclamation.h）：遍历和迭代器都处在 epoch_guard 中，
+//   节点只有在所有层都被摘下之后才交给 epoch_retire
+// - 与 ConcurrentList（每个节点一把锁、手递手加锁）相比，遍历不需要加锁，键有序，支持 lower_bound 与范围迭代
+// 注意：值在插入后不可修改；迭代器只能在创建它的线程中使用，并且持有期间会阻止内存回收
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_CONCURRENT_SKIP_LIST_H
+#define CPP_CONCURRENCY_IN_ACTION_CONCURRENT_SKIP_LIST_H
+
+#include "7.14_epoch_reclamation.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+
+template<class Key, class Value, class Compare = std::less<Key>>
+class ConcurrentSkipList{
+    struct Node;
+
+public:
+    using value_type = std::pair<const Key, Value>;
+
+    explicit ConcurrentSkipList(const Compare &comp = Compare{}): less_(comp), size_(0){
+        for(auto &x: head_){
+            x.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+    // 此时不应再有其它线程访问；仍在链上的节点都没有被 retire 过
+    ~ConcurrentSkipList(){
+        Node *p = unmarked(head_[0].load(std::memory_order_relaxed));
+        while(p){
+            Node *next = unmarked(p->next()[0].load(std::memory_order_relaxed));
+            destroy_node(p);
+            p = next;
+        }
+    }
+
+    // 正向迭代器，按键的升序访问；自身持有一个纪元临界区，跳过已被逻辑删除的节点
+    class const_iterator{
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const Key, Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator(): node(nullptr){}
+        const_iterator(const const_iterator &other): node(other.node){}
+        const_iterator& operator=(const const_iterator &other){
+            node = other.node;
+            return *this;
+        }
+
+        reference operator*() const{ return node->kv; }
+        pointer operator->() const{ return &node->kv; }
+        const_iterator& operator++(){
+            node = skip_deleted(unmarked(node->next()[0].load(std::memory_order_acquire)));
+            return *this;
+        }
+        const_iterator operator++(int){
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const const_iterator &other) const{
+            return node == other.node;
+        }
+
+    private:
+        friend class ConcurrentSkipList;
+        epoch_guard guard;
+        Node *node;
+
+        explicit const_iterator(Node *node_): node(skip_deleted(node_)){}
+    };
+
+    // 键已存在时返回 false，不覆盖原来的值
+    bool insert(const Key &key, const Value &value){
+        epoch_guard g;
+        int const levels = random_level();
+        std::atomic<Node*> *preds[max_level];
+        Node *succs[max_level];
+        Node *n = nullptr;
+        for(;;){
+            if(find(key, preds, succs)){
+                if(n){
+                    destroy_node(n);    // 从未发布过，直接释放
+                }
+                return false;
+            }
+            if(!n){
+                n = create_node(key, value, levels);
+            }
+            for(int l = 0; l < levels; ++l){
+                n->next()[l].store(succs[l], std::memory_order_relaxed);
+            }
+            Node *expected = succs[0];
+            if(preds[0][0].compare_exchange_strong(expected, n)){   // 链入第0层后节点即存在
+                break;
+            }
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+        link_upper_levels(n, key, preds, succs);
+        // 链接上层期间节点可能已被删除，而某一层是在删除者清理之后才链上的，需要自己再清理一遍
+        if(is_marked(n->next()[0].load())){
+            find(key, preds, succs);
+        }
+        release_unlink_ref(n);
+        return true;
+    }
+
+    bool erase(const Key &key){
+        epoch_guard g;
+        std::atomic<Node*> *preds[max_level];
+        Node *succs[max_level];
+        if(!find(key, preds, succs)){
+            return false;
+        }
+        Node *n = succs[0];
+        for(int l = n->levels - 1; l >= 1; --l){    // 自顶向下标记，阻止插入者继续链接上层
+            Node *next = n->next()[l].load();
+            while(!is_marked(next) && !n->next()[l].compare_exchange_weak(next, marked(next))){}
+        }
+        Node *next = n->next()[0].load();
+        for(;;){
+            if(is_marked(next)){
+                return false;   // 已被其它线程删除
+            }
+            if(n->next()[0].compare_exchange_weak(next, marked(next))){
+                break;
+            }
+        }
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        find(key, preds, succs);    // 在每一层把节点摘下
+        release_unlink_ref(n);
+        return true;
+    }
+
+    // 返回值的拷贝：离开临界区后节点随时可能被释放
+    std::optional<Value> find(const Key &key) const{
+        epoch_guard g;
+        Node *n = lower_bound_node(key);
+        if(n && !less_(key, n->kv.first)){
+            return n->kv.second;
+        }
+        return std::nullopt;
+    }
+
+    bool contains(const Key &key) const{
+        return find(key).has_value();
+    }
+
+    // 第一个不小于 key 的元素
+    const_iterator lower_bound(const Key &key) const{
+        epoch_guard g;
+        return const_iterator(lower_bound_node(key));
+    }
+
+    const_iterator begin() const{
+        epoch_guard g;
+        return const_iterator(unmarked(head_[0].load(std::memory_order_acquire)));
+    }
+
+    const_iterator end() const{
+        return const_iterator();
+    }
+
+    // 依次对 [from, to) 中的元素调用 f(const value_type&)
+    template<class Function>
+    void for_each(const Key &from, const Key &to, Function f) const{
+        for(const_iterator it = lower_bound(from); it != end() && less_(it->first, to); ++it){
+            f(*it);
+        }
+    }
+
+    template<class Function>
+    void for_each(Function f) const{
+        for(const_iterator it = begin(); it != end(); ++it){
+            f(*it);
+        }
+    }
+
+    // 并发修改时只是一个近似值
+    std::size_t size() const{
+        long const n = size_.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<std::size_t>(n) : 0;
+    }
+
+    bool empty() const{
+        return begin() == end();
+    }
+
+private:
+    static constexpr int max_level = 32;
+
+    // next 数组紧跟在节点之后分配，长度为 levels
+    struct alignas(std::atomic<void*>) Node{
+        value_type kv;
+        int const levels;
+        // 插入者完成上层链接、删除者完成摘除，各减一；减到0的一方负责 retire
+        std::atomic<int> unlink_refs;
+
+        Node(const Key &k, const Value &v, int levels_): kv(k, v), levels(levels_), unlink_refs(2){}
+
+        std::atomic<Node*>* next(){
+            return reinterpret_cast<std::atomic<Node*>*>(this + 1);
+        }
+    };
+
+    std::atomic<Node*> head_[max_level];
+    Compare less_;
+    std::atomic<long> size_;
+
+    // next 指针的最低位表示“所在节点已在这一层被逻辑删除”
+    static bool is_marked(Node *p){
+        return reinterpret_cast<std::uintptr_t>(p) & 1;
+    }
+    static Node* marked(Node *p){
+        return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(p) | 1);
+    }
+    static Node* unmarked(Node *p){
+        return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(1));
+    }
+
+    static Node* create_node(const Key &key, const Value &value, int levels){
+        void *mem = ::operator new(sizeof(Node) + sizeof(std::atomic<Node*>) * levels);
+        Node *n;
+        try{
+            n = ::new(mem) Node(key, value, levels);
+        }catch (...){
+            ::operator delete(mem);
+            throw;
+        }
+        for(int l = 0; l < levels; ++l){
+            ::new(static_cast<void*>(n->next() + l)) std::atomic<Node*>(nullptr);
+        }
+        return n;
+    }
+
+    static void destroy_node(void *p){
+        Node *n = static_cast<Node*>(p);
+        n->~Node();
+        ::operator delete(p);
+    }
+
+    static void release_unlink_ref(Node *n){
+        if(n->unlink_refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+            epoch_retire(n, &destroy_node);
+        }
+    }
+
+    // 层数服从 p = 1/4 的几何分布
+    static int random_level(){
+        thread_local std::uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        state ^= state << 13;   // xorshift64
+        state ^= state >> 7;
+        state ^= state << 17;
+        int const level = 1 + __builtin_ctzll(state | (std::uint64_t(1) << 62)) / 2;
+        return level < max_level ? level : max_level;
+    }
+
+    static Node* skip_deleted(Node *n){
+        while(n && is_marked(n->next()[0].load(std::memory_order_acquire))){
+            n = unmarked(n->next()[0].load(std::memory_order_acquire));
+        }
+        return n;
+    }
+
+    // 只读的查找：跳过（但不摘除）已标记的节点，返回第0层第一个键不小于 key 且未被删除的节点
+    Node* lower_bound_node(const Key &key) const{
+        std::atomic<Node*> const *pred = head_;
+        Node *curr = nullptr;
+        for(int level = max_level - 1; level >= 0; --level){
+            curr = unmarked(pred[level].load(std::memory_order_acquire));
+            while(curr){
+                Node *succ = curr->next()[level].load(std::memory_order_acquire);
+                while(is_marked(succ)){
+                    curr = unmarked(succ);
+                    if(!curr){
+                        break;
+                    }
+                    succ = curr->next()[level].load(std::memory_order_acquire);
+                }
+                if(!curr || !less_(curr->kv.first, key)){
+                    break;
+                }
+                pred = curr->next();
+                curr = unmarked(succ);
+            }
+        }
+        return skip_deleted(curr);
+    }
+
+    // 找出每一层中 key 的前驱（的 next 数组）与后继，途中摘除所有遇到的已标记节点。返回 key 是否存在
+    bool find(const Key &key, std::atomic<Node*> **preds, Node **succs) const{
+        for(;;){
+            int const res = try_find(key, preds, succs);
+            if(res >= 0){
+                return res;
+            }
+        }
+    }
+
+    // 摘除时CAS失败（前驱已变化或已被删除）返回 -1，需要从头重来
+    int try_find(const Key &key, std::atomic<Node*> **preds, Node **succs) const{
+        std::atomic<Node*> *pred = const_cast<std::atomic<Node*>*>(head_);
+        Node *curr = nullptr;
+        for(int level = max_level - 1; level >= 0; --level){
+            curr = pred[level].load();
+            if(is_marked(curr)){
+                return -1;      // 前驱自身已被删除
+            }
+            while(curr){
+                Node *succ = curr->next()[level].load();
+                while(is_marked(succ)){
+                    Node *expected = curr;
+                    if(!pred[level].compare_exchange_strong(expected, unmarked(succ))){
+                        return -1;
+                    }
+                    curr = unmarked(succ);
+                    if(!curr){
+                        break;
+                    }
+                    succ = curr->next()[level].load();
+                }
+                if(!curr || !less_(curr->kv.first, key)){
+                    break;
+                }
+                pred = curr->next();
+                curr = succ;
+            }
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+        return curr && !less_(key, curr->kv.first);
+    }
+
+    void link_upper_levels(Node *n, const Key &key, std::atomic<Node*> **preds, Node **succs){
+        for(int l = 1; l < n->levels; ++l){
+            for(;;){
+                Node *next = n->next()[l].load();
+                if(is_marked(next)){
+                    return;     // 正在被删除，不再链接
+                }
+                if(next != succs[l] && !n->next()[l].compare_exchange_strong(next, succs[l])){
+                    return;     // 只有删除者的标记会让这个CAS失败
+                }
+                Node *expected = succs[l];
+                if(preds[l][l].compare_exchange_strong(expected, n)){
+                    break;
+                }
+                find(key, preds, succs);    // 前驱已变化，重新定位
+                if(succs[0] != n){
+                    return;     // 已被删除
+                }
+            }
+        }
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_CONCURRENT_SKIP_LIST_H
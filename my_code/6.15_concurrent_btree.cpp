@@ -0,0 +1,171 @@
+//
+// Created by chen on 2026/10/18.
+//
+// ConcurrentBTree 的正确性检查与性能测试
+// 1. 多个线程并发插入/删除互不重叠的键，最后检查内容与有序性
+// 2. 点查询、读多写少混合负载、范围扫描的吞吐量，与 ConcurrentSkipList 以及“std::map + 读写锁”对比
+
+#include "6.14_concurrent_skip_list.h"
+#include "6.15_concurrent_btree.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+bool check_correctness(){
+    ConcurrentBTree<std::uint64_t, std::uint64_t> tree;
+    int const thread_count = 4, per_thread = 50000;
+    bool ok = true;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < thread_count; ++t){
+        threads.emplace_back([&, t]{
+            std::mt19937 engine(t);
+            std::vector<std::uint64_t> keys;
+            for(int i = 0; i < per_thread; ++i){
+                keys.push_back(std::uint64_t(i) * thread_count + t);
+            }
+            std::shuffle(keys.begin(), keys.end(), engine);
+            for(auto k: keys){
+                tree.insert(k, k * 2);
+            }
+            for(auto k: keys){
+                if(k / thread_count % 2 == 0){
+                    tree.erase(k);
+                }
+            }
+            for(auto k: keys){
+                std::optional<std::uint64_t> v = tree.find(k);
+                if(v.has_value() != (k / thread_count % 2 == 1) || (v && *v != k * 2)){
+                    ok = false;
+                }
+            }
+        });
+    }
+    for(auto &t: threads){
+        t.join();
+    }
+    std::uint64_t count = 0, prev = 0;
+    tree.for_each(0, ~std::uint64_t(0), [&](std::uint64_t k, std::uint64_t v){
+        ok = ok && (count == 0 || k > prev) && k / thread_count % 2 == 1 && v == k * 2;
+        prev = k;
+        ++count;
+    });
+    std::uint64_t range_count = 0;
+    tree.for_each(1000, 2000, [&](std::uint64_t k, std::uint64_t){
+        ok = ok && k >= 1000 && k < 2000;
+        ++range_count;
+    });
+    ok = ok && count == std::uint64_t(thread_count) * per_thread / 2 && tree.size() == count && range_count == 500
+         && !tree.insert(1 * thread_count + 1, 0) && tree.insert_or_assign(5, 7) == false && tree.find(5) == 7u;
+    std::cout << "correctness: " << count << " keys" << (ok ? "  check." : "  MISMATCH") << std::endl;
+    return ok;
+}
+
+// 对照组：std::map 加一把读写锁
+struct locked_map{
+    std::map<std::uint64_t, std::uint64_t> map;
+    mutable std::shared_mutex m;
+    std::optional<std::uint64_t> find(std::uint64_t k) const{
+        std::shared_lock<std::shared_mutex> l(m);
+        auto it = map.find(k);
+        return it == map.end() ? std::nullopt : std::optional<std::uint64_t>(it->second);
+    }
+    bool insert(std::uint64_t k, std::uint64_t v){
+        std::unique_lock<std::shared_mutex> l(m);
+        return map.emplace(k, v).second;
+    }
+    bool erase(std::uint64_t k){
+        std::unique_lock<std::shared_mutex> l(m);
+        return map.erase(k);
+    }
+    template<class Function>
+    void for_each(std::uint64_t from, std::uint64_t to, Function f) const{
+        std::shared_lock<std::shared_mutex> l(m);
+        for(auto it = map.lower_bound(from); it != map.end() && it->first < to; ++it){
+            f(it->first, it->second);
+        }
+    }
+};
+
+// ConcurrentSkipList 的 for_each 回调参数是 pair，包装成同样的接口
+struct skip_list_adapter{
+    ConcurrentSkipList<std::uint64_t, std::uint64_t> list;
+    std::optional<std::uint64_t> find(std::uint64_t k) const{ return list.find(k); }
+    bool insert(std::uint64_t k, std::uint64_t v){ return list.insert(k, v); }
+    bool erase(std::uint64_t k){ return list.erase(k); }
+    template<class Function>
+    void for_each(std::uint64_t from, std::uint64_t to, Function f) const{
+        list.for_each(from, to, [&](const std::pair<const std::uint64_t, std::uint64_t> &kv){
+            f(kv.first, kv.second);
+        });
+    }
+};
+
+// write_percent% 的操作为插入/删除（各一半），scan_percent% 为长度约100的范围扫描，其余为点查询
+template<class Map>
+double run(Map &map, unsigned thread_count, std::uint64_t key_range, int ops, int write_percent, int scan_percent){
+    std::vector<std::thread> threads;
+    std::atomic<std::uint64_t> sink(0);
+    auto const start = std::chrono::steady_clock::now();
+    for(unsigned t = 0; t < thread_count; ++t){
+        threads.emplace_back([&, t]{
+            std::mt19937_64 engine(t + 1);
+            std::uint64_t local = 0;
+            for(int i = 0; i < ops; ++i){
+                std::uint64_t const k = engine() % key_range;
+                int const o = int(engine() % 100);
+                if(o < write_percent / 2){
+                    map.insert(k, k);
+                }else if(o < write_percent){
+                    map.erase(k);
+                }else if(o < write_percent + scan_percent){
+                    map.for_each(k, k + 200, [&](std::uint64_t, std::uint64_t v){ local += v; });
+                }else if(auto v = map.find(k)){
+                    local += *v;
+                }
+            }
+            sink += local;
+        });
+    }
+    for(auto &t: threads){
+        t.join();
+    }
+    auto const us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return us ? double(thread_count) * ops / us : 0.0;
+}
+
+template<class Map>
+void bench(const char *name, std::uint64_t key_range, unsigned max_threads){
+    for(auto [write_percent, scan_percent, label]: {std::tuple{0, 0, "lookup"}, std::tuple{10, 0, "90/10 "},
+                                                    std::tuple{0, 10, "scan  "}}){
+        std::cout << name << " " << label;
+        for(unsigned threads = 1; threads <= max_threads; threads *= 2){
+            Map map;
+            for(std::uint64_t k = 0; k < key_range; k += 2){
+                map.insert(k, k);
+            }
+            std::cout << "  " << threads << "T: " << run(map, threads, key_range, 200000, write_percent, scan_percent);
+        }
+        std::cout << "  M ops/s" << std::endl;
+    }
+}
+
+int main(){
+    if(!check_correctness()){
+        return 1;
+    }
+    unsigned const max_threads = std::max(4u, std::thread::hardware_concurrency());
+    std::uint64_t const key_range = 1000000;
+    bench<ConcurrentBTree<std::uint64_t, std::uint64_t>>("btree     ", key_range, max_threads);
+    bench<skip_list_adapter>("skip list ", key_range, max_threads);
+    bench<locked_map>("std::map  ", key_range, max_threads);
+    return 0;
+}
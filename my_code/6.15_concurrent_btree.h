@@ -0,0 +1,520 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 基于乐观锁耦合（optimistic lock coupling，Leis 等）的并发 B+ 树
+// - 每个节点一个“版本号 + 写锁位”。读者不加锁：读节点前记下版本号，读完（以及拿到子节点指针之后、访问子节点之前）
+//   再核对一次，版本变了就从根重新开始；写者只锁住要修改的叶子，分裂时再锁住父节点
+// - 插入时遇到满的内部节点就提前分裂，保证父节点总有位置放分隔键，任何时候最多同时锁两个节点
+// - 叶子之间有 next 指针，范围扫描逐个叶子复制数据、校验版本，然后沿链表前进
+// - 删除只从叶子中移除元素，不做合并，因此节点在树析构之前不会被释放，乐观读者拿到的指针总是有效的
+// - 节点大小 NodeBytes 默认 1024 字节（16 个缓存行），键和子节点指针/值分开存放，二分查找只访问键数组
+// 注意：乐观读会读到写了一半的数据（随后由版本号校验丢弃），因此 Key 与 Value 必须是可平凡复制的类型。
+//      读者可能同时在读的节点内容（键、值、子节点指针）都通过 relaxed 原子操作读写（见 atomic_bytes.h），不构成数据竞争；
+//      读者总是先把键、值拷贝出来再比较或使用
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_CONCURRENT_BTREE_H
+#define CPP_CONCURRENCY_IN_ACTION_CONCURRENT_BTREE_H
+
+#include "atomic_bytes.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<class Key, class Value, class Compare = std::less<Key>, std::size_t NodeBytes = 1024>
+class ConcurrentBTree{
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "optimistic reads require trivially copyable Key and Value");
+
+public:
+    explicit ConcurrentBTree(const Compare &comp = Compare{}): less_(comp), size_(0){
+        root_.store(new Leaf(), std::memory_order_relaxed);
+    }
+    ConcurrentBTree(const ConcurrentBTree&) = delete;
+    ConcurrentBTree& operator=(const ConcurrentBTree&) = delete;
+
+    ~ConcurrentBTree(){
+        destroy(root_.load(std::memory_order_relaxed));
+    }
+
+    std::optional<Value> find(const Key &key) const{
+        for(;;){
+            Leaf *leaf;
+            std::uint64_t v;
+            if(!find_leaf(key, leaf, v)){
+                continue;
+            }
+            unsigned const n = leaf->size();
+            unsigned const pos = leaf->lower_bound(key, less_);
+            std::optional<Value> res;
+            if(pos < n && equal(leaf->key(pos), key)){
+                res = leaf->value(pos);
+            }
+            if(leaf->check(v)){
+                return res;
+            }
+        }
+    }
+
+    bool contains(const Key &key) const{
+        return find(key).has_value();
+    }
+
+    // 键已存在时返回 false，不覆盖原来的值
+    bool insert(const Key &key, const Value &value){
+        return insert_impl(key, value, false);
+    }
+
+    // 键已存在时覆盖，返回是否插入了新元素
+    bool insert_or_assign(const Key &key, const Value &value){
+        return insert_impl(key, value, true);
+    }
+
+    bool erase(const Key &key){
+        for(;;){
+            Node *node = root_.load(std::memory_order_acquire);
+            std::uint64_t v;
+            if(!node->read_lock(v) || node != root_.load(std::memory_order_acquire)){
+                continue;
+            }
+            Inner *parent = nullptr;
+            std::uint64_t parent_v = 0;
+            if(!descend(key, node, v, parent, parent_v)){
+                continue;
+            }
+            Leaf *leaf = static_cast<Leaf*>(node);
+            if(!leaf->upgrade(v)){
+                continue;
+            }
+            if(parent && !parent->check(parent_v)){
+                leaf->write_unlock();
+                continue;
+            }
+            bool const erased = leaf->erase(key, less_);
+            leaf->write_unlock();
+            if(erased){
+                size_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            return erased;
+        }
+    }
+
+    // 按键的升序对 [from, to) 中的元素调用 f(const Key&, const Value&)。
+    // 逐个叶子复制并校验，f 只会看到一致的数据；扫描本身不是原子快照
+    template<class Function>
+    void for_each(const Key &from, const Key &to, Function f) const{
+        std::pair<Key, Value> buffer[Leaf::capacity];
+        std::optional<Key> last;    // 已经交给 f 的最后一个键
+        for(;;){
+            Leaf *leaf;
+            std::uint64_t v;
+            if(!find_leaf(last ? *last : from, leaf, v)){
+                continue;
+            }
+            for(;;){
+                unsigned const n = leaf->size();
+                unsigned count = 0;
+                bool reached_end = false;
+                for(unsigned i = 0; i < n; ++i){
+                    Key const k = leaf->key(i);
+                    if(!less_(k, to)){
+                        reached_end = true;
+                        break;
+                    }
+                    if(less_(k, from) || (last && !less_(*last, k))){
+                        continue;
+                    }
+                    buffer[count++] = std::pair<Key, Value>(k, leaf->value(i));
+                }
+                Leaf *next = leaf->next.load(std::memory_order_acquire);
+                if(!leaf->check(v)){
+                    break;      // 叶子被修改过，从 last 处重新定位
+                }
+                for(unsigned i = 0; i < count; ++i){
+                    f(static_cast<const Key&>(buffer[i].first), static_cast<const Value&>(buffer[i].second));
+                }
+                if(count){
+                    last = buffer[count - 1].first;
+                }
+                if(reached_end || !next){
+                    return;
+                }
+                leaf = next;
+                leaf->wait_read_lock(v);
+            }
+        }
+    }
+
+    // 并发修改时只是一个近似值
+    std::size_t size() const{
+        long const n = size_.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<std::size_t>(n) : 0;
+    }
+
+private:
+    // 版本号的最低位为写锁位，解锁时加一次锁位即得到新的版本号
+    struct Node{
+        static constexpr std::uint64_t locked_bit = 1;
+
+        std::atomic<std::uint64_t> version{0};
+        std::atomic<std::uint16_t> count{0};
+        bool const is_leaf;
+
+        explicit Node(bool is_leaf_): is_leaf(is_leaf_){}
+
+        // 节点未被写锁住时记下版本号；否则返回 false，由调用者重新开始
+        bool read_lock(std::uint64_t &v) const{
+            v = version.load(std::memory_order_acquire);
+            if(v & locked_bit){
+                std::this_thread::yield();
+                return false;
+            }
+            return true;
+        }
+
+        void wait_read_lock(std::uint64_t &v) const{
+            while(!read_lock(v)){}
+        }
+
+        // 读完节点之后核对版本号没有变化
+        bool check(std::uint64_t v) const{
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return version.load(std::memory_order_relaxed) == v;
+        }
+
+        // 成功后的 release 栅栏与 check 中的 acquire 栅栏配对：读者只要读到了加锁之后写入的数据，
+        // 之后读版本号时就一定能看到加锁后的版本，从而丢弃这次读到的数据
+        bool upgrade(std::uint64_t v){
+            if(!version.compare_exchange_strong(v, v + locked_bit, std::memory_order_acquire)){
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            return true;
+        }
+
+        void write_unlock(){
+            version.fetch_add(locked_bit, std::memory_order_release);
+        }
+    };
+
+    struct Inner;
+    struct Leaf;
+
+    // 节点的头部之后，剩余空间平均分给键和子节点指针/值
+    static constexpr std::size_t header_bytes = 16;
+    static constexpr std::size_t inner_capacity = (NodeBytes - header_bytes - sizeof(Node*)) / (sizeof(Key) + sizeof(Node*));
+    static constexpr std::size_t leaf_capacity = (NodeBytes - header_bytes - sizeof(Leaf*)) / (sizeof(Key) + sizeof(Value));
+    static_assert(inner_capacity >= 4 && leaf_capacity >= 4, "NodeBytes is too small for Key/Value");
+
+    // 在已经被读者看到的节点中移动元素（写者持有该节点的写锁）：每个元素都用原子写入，写者自己的读不需要原子操作
+    template<class T>
+    static void store_range(T *dst, const T *first, const T *last){
+        for(; first != last; ++first, ++dst){
+            atomic_store_bytes(dst, *first);
+        }
+    }
+
+    template<class T>
+    static void store_range_backward(T *dst_last, const T *first, const T *last){
+        while(last != first){
+            atomic_store_bytes(--dst_last, *--last);
+        }
+    }
+
+    // 在 keys[0, n) 中二分查找第一个不小于 key 的位置，每个键都先原子地拷贝出来再比较
+    static unsigned lower_bound_in(const Key *keys, unsigned n, const Key &key, const Compare &less){
+        unsigned first = 0;
+        while(n > 0){
+            unsigned const half = n / 2;
+            if(less(atomic_load_copy(keys + first + half), key)){
+                first += half + 1;
+                n -= half + 1;
+            }else{
+                n = half;
+            }
+        }
+        return first;
+    }
+
+    // count 个分隔键与 count + 1 个子节点；keys[i] 是 children[i] 中的最大键
+    struct Inner: Node{
+        static constexpr unsigned capacity = inner_capacity;
+        Key keys[capacity];
+        std::atomic<Node*> children[capacity + 1];
+
+        Inner(): Node(false){}
+
+        Node* child(unsigned i) const{
+            return children[i].load(std::memory_order_relaxed);
+        }
+
+        unsigned size() const{
+            return std::min<unsigned>(this->count.load(std::memory_order_relaxed), capacity - 1);
+        }
+
+        bool full() const{
+            return this->count.load(std::memory_order_relaxed) == capacity - 1;
+        }
+
+        unsigned lower_bound(const Key &key, const Compare &less) const{
+            return lower_bound_in(keys, size(), key, less);
+        }
+
+        // 分裂出右半部分，sep 为留在左半部分的最大键
+        Inner* split(Key &sep){
+            Inner *right = new Inner();
+            unsigned const n = size();
+            unsigned const right_count = n - n / 2;
+            unsigned const left_count = n - right_count - 1;
+            sep = keys[left_count];
+            std::copy(keys + left_count + 1, keys + n, right->keys);     // right 尚未发布，不会有读者
+            for(unsigned i = left_count + 1; i <= n; ++i){
+                right->children[i - left_count - 1].store(child(i), std::memory_order_relaxed);
+            }
+            right->count.store(right_count, std::memory_order_relaxed);
+            this->count.store(left_count, std::memory_order_relaxed);
+            return right;
+        }
+
+        // left 分裂为 left 与 right，sep 为 left 的最大键
+        void insert(const Key &sep, Node *right, const Compare &less){
+            unsigned const n = size();
+            unsigned const pos = lower_bound(sep, less);
+            store_range_backward(keys + n + 1, keys + pos, keys + n);
+            for(unsigned i = n + 1; i > pos + 1; --i){
+                children[i].store(child(i - 1), std::memory_order_relaxed);
+            }
+            atomic_store_bytes(&keys[pos], sep);
+            children[pos + 1].store(right, std::memory_order_relaxed);
+            this->count.store(n + 1, std::memory_order_relaxed);
+        }
+    };
+
+    struct Leaf: Node{
+        static constexpr unsigned capacity = leaf_capacity;
+        std::atomic<Leaf*> next{nullptr};
+        Key keys[capacity];
+        Value values[capacity];
+
+        Leaf(): Node(true){}
+
+        Key key(unsigned i) const{
+            return atomic_load_copy(&keys[i]);
+        }
+
+        Value value(unsigned i) const{
+            return atomic_load_copy(&values[i]);
+        }
+
+        unsigned size() const{
+            return std::min<unsigned>(this->count.load(std::memory_order_relaxed), capacity);
+        }
+
+        bool full() const{
+            return this->count.load(std::memory_order_relaxed) == capacity;
+        }
+
+        unsigned lower_bound(const Key &key, const Compare &less) const{
+            return lower_bound_in(keys, size(), key, less);
+        }
+
+        Leaf* split(Key &sep){
+            Leaf *right = new Leaf();
+            unsigned const n = size();
+            unsigned const right_count = n - n / 2;
+            unsigned const left_count = n - right_count;
+            std::copy(keys + left_count, keys + n, right->keys);         // right 尚未发布，不会有读者
+            std::copy(values + left_count, values + n, right->values);
+            right->count.store(right_count, std::memory_order_relaxed);
+            right->next.store(next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            this->count.store(left_count, std::memory_order_relaxed);
+            next.store(right, std::memory_order_release);
+            sep = keys[left_count - 1];
+            return right;
+        }
+
+        // 返回是否插入了新元素；调用前需保证未满
+        bool insert(const Key &key, const Value &value, bool assign, const Compare &less){
+            unsigned const n = size();
+            unsigned const pos = lower_bound(key, less);
+            if(pos < n && !less(key, keys[pos])){
+                if(assign){
+                    atomic_store_bytes(&values[pos], value);
+                }
+                return false;
+            }
+            store_range_backward(keys + n + 1, keys + pos, keys + n);
+            store_range_backward(values + n + 1, values + pos, values + n);
+            atomic_store_bytes(&keys[pos], key);
+            atomic_store_bytes(&values[pos], value);
+            this->count.store(n + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool erase(const Key &key, const Compare &less){
+            unsigned const n = size();
+            unsigned const pos = lower_bound(key, less);
+            if(pos == n || less(key, keys[pos])){
+                return false;
+            }
+            store_range(keys + pos, keys + pos + 1, keys + n);
+            store_range(values + pos, values + pos + 1, values + n);
+            this->count.store(n - 1, std::memory_order_relaxed);
+            return true;
+        }
+    };
+
+    std::atomic<Node*> root_;
+    Compare less_;
+    std::atomic<long> size_;
+
+    bool equal(const Key &a, const Key &b) const{
+        return !less_(a, b) && !less_(b, a);
+    }
+
+    static void destroy(Node *node){
+        if(node->is_leaf){
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        Inner *inner = static_cast<Inner*>(node);
+        for(unsigned i = 0; i <= inner->size(); ++i){
+            destroy(inner->child(i));
+        }
+        delete inner;
+    }
+
+    // 从 node（已记下版本号 v）一路下降到叶子，parent 为叶子的父节点（叶子就是根时为空）。失败时需从根重新开始
+    bool descend(const Key &key, Node *&node, std::uint64_t &v, Inner *&parent, std::uint64_t &parent_v) const{
+        while(!node->is_leaf){
+            Inner *inner = static_cast<Inner*>(node);
+            if(parent && !parent->check(parent_v)){
+                return false;
+            }
+            parent = inner;
+            parent_v = v;
+            node = inner->child(inner->lower_bound(key, less_));
+            if(!inner->check(v)){   // 子节点指针可能是写了一半的数据，核对之后才能访问
+                return false;
+            }
+            if(!node->read_lock(v)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 找到 key 所在的叶子并记下其版本号；叶子中的数据仍需调用者读完后校验
+    bool find_leaf(const Key &key, Leaf *&leaf, std::uint64_t &v) const{
+        Node *node = root_.load(std::memory_order_acquire);
+        if(!node->read_lock(v) || node != root_.load(std::memory_order_acquire)){
+            return false;
+        }
+        Inner *parent = nullptr;
+        std::uint64_t parent_v = 0;
+        if(!descend(key, node, v, parent, parent_v)){
+            return false;
+        }
+        if(parent && !parent->check(parent_v)){
+            return false;
+        }
+        leaf = static_cast<Leaf*>(node);
+        return true;
+    }
+
+    // 锁住 parent（可能为空，此时 node 必须仍是根）与 node 后分裂 node，完成后总是需要从根重新开始
+    void split(Node *node, std::uint64_t v, Inner *parent, std::uint64_t parent_v){
+        if(parent && !parent->upgrade(parent_v)){
+            return;
+        }
+        if(!node->upgrade(v)){
+            if(parent){
+                parent->write_unlock();
+            }
+            return;
+        }
+        if(!parent && node != root_.load(std::memory_order_acquire)){   // 其它线程已经分裂了根
+            node->write_unlock();
+            return;
+        }
+        Key sep;
+        Node *right = node->is_leaf ? static_cast<Node*>(static_cast<Leaf*>(node)->split(sep))
+                                    : static_cast<Node*>(static_cast<Inner*>(node)->split(sep));
+        if(parent){
+            parent->insert(sep, right, less_);
+        }else{
+            Inner *new_root = new Inner();
+            new_root->keys[0] = sep;
+            new_root->children[0].store(node, std::memory_order_relaxed);
+            new_root->children[1].store(right, std::memory_order_relaxed);
+            new_root->count.store(1, std::memory_order_relaxed);
+            root_.store(new_root, std::memory_order_release);
+        }
+        node->write_unlock();
+        if(parent){
+            parent->write_unlock();
+        }
+    }
+
+    bool insert_impl(const Key &key, const Value &value, bool assign){
+        for(;;){
+            Node *node = root_.load(std::memory_order_acquire);
+            std::uint64_t v;
+            if(!node->read_lock(v) || node != root_.load(std::memory_order_acquire)){
+                continue;
+            }
+            Inner *parent = nullptr;
+            std::uint64_t parent_v = 0;
+            bool restart = false;
+            while(!node->is_leaf){
+                Inner *inner = static_cast<Inner*>(node);
+                if(inner->full()){      // 提前分裂满的内部节点，保证之后父节点总有空位
+                    split(inner, v, parent, parent_v);
+                    restart = true;
+                    break;
+                }
+                if(parent && !parent->check(parent_v)){
+                    restart = true;
+                    break;
+                }
+                parent = inner;
+                parent_v = v;
+                node = inner->child(inner->lower_bound(key, less_));
+                if(!inner->check(v) || !node->read_lock(v)){
+                    restart = true;
+                    break;
+                }
+            }
+            if(restart){
+                continue;
+            }
+
+            Leaf *leaf = static_cast<Leaf*>(node);
+            if(leaf->full()){
+                split(leaf, v, parent, parent_v);
+                continue;
+            }
+            if(!leaf->upgrade(v)){
+                continue;
+            }
+            if(parent && !parent->check(parent_v)){
+                leaf->write_unlock();
+                continue;
+            }
+            bool const inserted = leaf->insert(key, value, assign, less_);
+            leaf->write_unlock();
+            if(inserted){
+                size_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return inserted;
+        }
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_CONCURRENT_BTREE_H
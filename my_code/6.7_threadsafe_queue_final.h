@@ -32,6 +32,31 @@ public:
         data_cond.notify_one();
     }
 
+    // 批量入队：新节点链在锁外构造好，只需持有一次 tail_mutex 即可整体挂到队尾
+    template<class Iterator>
+    void push_batch(Iterator first, Iterator last){
+        if(first == last){
+            return;
+        }
+        std::shared_ptr<T> first_data(std::make_shared<T>(std::move(*first)));  // 放入当前虚节点
+        std::unique_ptr<node> chain(new node);
+        node *chain_tail = chain.get();
+        for(++first; first != last; ++first){
+            chain_tail->data = std::make_shared<T>(std::move(*first));
+            chain_tail->next.reset(new node);
+            chain_tail = chain_tail->next.get();
+        }   // 循环结束后 chain_tail 是新的虚节点
+
+        {
+            std::lock_guard<std::mutex> tail_lock(tail_mutex);
+            tail->data = first_data;
+            tail->next = std::move(chain);
+            tail = chain_tail;
+        }
+
+        data_cond.notify_all();
+    }
+
     std::shared_ptr<T> wait_and_pop(){
         std::unique_ptr<node> const old_head = wait_pop_head();
 //        std::cout << "[wait_pop] " << *old_head->data << std::endl;
@@ -0,0 +1,79 @@
+//
+// Created by chen on 2026/10/18.
+//
+// bounded_mpmc_queue 与 threadsafe_queue 的对比测试：多个生产者、多个消费者，检查所有数据恰好被取出一次
+// 另外测试单线程 try_push/try_pop 的开销（没有等待者时通知不应带来栅栏），
+// 以及容量很小、生产者与消费者数量不对称时阻塞的 push / wait_and_pop 不会丢失唤醒
+
+#include "6.7_threadsafe_queue_final.h"
+#include "6.8_bounded_mpmc_queue.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+template<class Queue>
+void bench(const char *name, Queue &q, int producers, int consumers, int items_per_producer){
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> threads;
+    int const total = producers * items_per_producer;
+    auto const start = std::chrono::steady_clock::now();
+    for(int p = 0; p < producers; ++p){
+        threads.emplace_back([&q, p, items_per_producer]{
+            for(int i = 0; i < items_per_producer; ++i){
+                q.push(p * items_per_producer + i);
+            }
+        });
+    }
+    for(int c = 0; c < consumers; ++c){
+        threads.emplace_back([&q, &sum, c, consumers, total]{
+            long long local = 0;
+            int const n = total / consumers + (c < total % consumers ? 1 : 0);
+            for(int i = 0; i < n; ++i){
+                int value;
+                q.wait_and_pop(value);
+                local += value;
+            }
+            sum += local;
+        });
+    }
+    for(auto &t: threads){
+        t.join();
+    }
+    auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    long long const expected = 1LL * total * (total - 1) / 2;
+    std::cout << name << " " << producers << "P/" << consumers << "C: " << ms << " ms, "
+              << (ms ? total / ms / 1000.0 : 0.0) << " M items/s" << (sum == expected ? "  check." : "  MISMATCH") << std::endl;
+}
+
+// 单线程交替 try_push / try_pop，每对操作的平均耗时
+void bench_uncontended(int rounds){
+    bounded_mpmc_queue<int> q(1024);
+    long long sum = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for(int i = 0; i < rounds; ++i){
+        int value = 0;
+        q.try_push(i);
+        q.try_pop(value);
+        sum += value;
+    }
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "uncontended try_push + try_pop: " << double(ns) / rounds << " ns"
+              << (sum == 1LL * rounds * (rounds - 1) / 2 ? "  check." : "  MISMATCH") << std::endl;
+}
+
+int main(){
+    int const items = 1000000;
+    bench_uncontended(10000000);
+    for(int threads: {1, 2, 4}){
+        threadsafe_queue<int> q1;
+        bench("threadsafe_queue  ", q1, threads, threads, items / threads);
+        bounded_mpmc_queue<int> q2(1024);
+        bench("bounded_mpmc_queue", q2, threads, threads, items / threads);
+    }
+    // 容量为 2：队列几乎总是满或空，大部分操作都要经过等待与唤醒
+    bounded_mpmc_queue<int> small1(2), small2(2);
+    bench("capacity 2        ", small1, 4, 1, items / 40);
+    bench("capacity 2        ", small2, 1, 4, items / 10);
+    return 0;
+}
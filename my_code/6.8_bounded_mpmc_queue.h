@@ -0,0 +1,186 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 有界的无锁多生产者多消费者队列（Vyukov 风格的环形缓冲区）
+// - 每个槽位带一个序号 seq，生产者/消费者通过比较 seq 与自己拿到的位置判断槽位是否可写/可读，
+//   只需对 enqueue_pos / dequeue_pos 做一次CAS
+// - 槽位按缓存行对齐，构造之后不再分配内存
+// - 接口与 threadsafe_queue 保持一致（push / wait_and_pop / try_pop / empty），另外提供非阻塞的 try_push；
+//   阻塞版本只在队列满/空时才会去睡眠，正常路径不会碰到等待原语
+// - 成功的 try_push / try_pop 只多一次对等待者计数的读，没有栅栏：领取位置的 CAS 是 seq_cst 的，
+//   与等待方登记后的栅栏排成全序，要么通知方看到等待者，要么等待方在睡眠前看到位置已经前进
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_BOUNDED_MPMC_QUEUE_H
+#define CPP_CONCURRENCY_IN_ACTION_BOUNDED_MPMC_QUEUE_H
+
+#include "9.7_threadpool_4/event_count.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+template<class T>
+class bounded_mpmc_queue{
+public:
+    // capacity 必须是2的幂
+    explicit bounded_mpmc_queue(std::size_t capacity = 1024):
+            mask(capacity - 1), slots(new slot[capacity]), enqueue_pos(0), dequeue_pos(0){
+        if(capacity < 2 || (capacity & (capacity - 1)) != 0){
+            throw std::invalid_argument("bounded_mpmc_queue capacity must be a power of 2.");
+        }
+        for(std::size_t i = 0; i < capacity; ++i){
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    bounded_mpmc_queue(const bounded_mpmc_queue&) = delete;
+    bounded_mpmc_queue& operator=(const bounded_mpmc_queue&) = delete;
+
+    ~bounded_mpmc_queue(){
+        T tmp;
+        while(try_pop(tmp)){}
+    }
+
+    // 队列已满时返回 false
+    bool try_push(T new_value){
+        return enqueue(new_value);
+    }
+
+    // 队列已满时阻塞，直到有空位
+    void push(T new_value){
+        for(unsigned i = 0; !enqueue(new_value); ++i){
+            if(i < spin_rounds){    // 先短暂让出时间片，多数情况下消费者很快就会腾出空位
+                std::this_thread::yield();
+                continue;
+            }
+            auto const key = not_full.prepare_wait();
+            if(!full()){
+                not_full.cancel_wait();
+                continue;
+            }
+            not_full.commit_wait(key);
+        }
+    }
+
+    template<class Iterator>
+    void push_batch(Iterator first, Iterator last){
+        for(; first != last; ++first){
+            push(std::move(*first));
+        }
+    }
+
+    bool try_pop(T &value){
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        slot *s;
+        for(;;){
+            s = &slots[pos & mask];
+            std::size_t const seq = s->seq.load(std::memory_order_acquire);
+            std::ptrdiff_t const diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+            if(diff == 0){          // 槽位已写好，尝试领取
+                if(dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+                    break;
+                }
+            }else if(diff < 0){     // 槽位还没被写入：队列为空
+                return false;
+            }else{
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        T *p = std::launder(reinterpret_cast<T*>(s->storage));
+        value = std::move(*p);
+        p->~T();
+        s->seq.store(pos + mask + 1, std::memory_order_release);   // 槽位留给下一轮的生产者
+        not_full.notify_one_after_rmw();
+        return true;
+    }
+
+    std::shared_ptr<T> try_pop(){
+        T value;
+        if(try_pop(value)){
+            return std::make_shared<T>(std::move(value));
+        }
+        return std::shared_ptr<T>();
+    }
+
+    // 队列为空时阻塞，直到有数据
+    void wait_and_pop(T &value){
+        for(unsigned i = 0; !try_pop(value); ++i){
+            if(i < spin_rounds){
+                std::this_thread::yield();
+                continue;
+            }
+            auto const key = not_empty.prepare_wait();
+            if(!empty()){
+                not_empty.cancel_wait();
+                continue;
+            }
+            not_empty.commit_wait(key);
+        }
+    }
+
+    std::shared_ptr<T> wait_and_pop(){
+        T value;
+        wait_and_pop(value);
+        return std::make_shared<T>(std::move(value));
+    }
+
+    // 并发修改时只是一个近似值
+    bool empty() const{
+        return enqueue_pos.load(std::memory_order_acquire) <= dequeue_pos.load(std::memory_order_acquire);
+    }
+
+    bool full() const{
+        return enqueue_pos.load(std::memory_order_acquire) - dequeue_pos.load(std::memory_order_acquire) > mask;
+    }
+
+    std::size_t capacity() const{
+        return mask + 1;
+    }
+
+private:
+    static constexpr std::size_t cache_line_size = 64;
+    static constexpr unsigned spin_rounds = 16;
+
+    struct alignas(cache_line_size) slot{
+        std::atomic<std::size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::size_t const mask;
+    std::unique_ptr<slot[]> const slots;
+
+    // 生产者与消费者的位置各占一个缓存行
+    alignas(cache_line_size) std::atomic<std::size_t> enqueue_pos;
+    alignas(cache_line_size) std::atomic<std::size_t> dequeue_pos;
+
+    alignas(cache_line_size) event_count not_empty;
+    event_count not_full;
+
+    // 成功时才会移走 value，因此 push 可以在失败后重试
+    bool enqueue(T &value){
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        slot *s;
+        for(;;){
+            s = &slots[pos & mask];
+            std::size_t const seq = s->seq.load(std::memory_order_acquire);
+            std::ptrdiff_t const diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+            if(diff == 0){
+                if(enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+                    break;
+                }
+            }else if(diff < 0){
+                return false;
+            }else{
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        ::new(static_cast<void*>(s->storage)) T(std::move(value));
+        s->seq.store(pos + 1, std::memory_order_release);
+        not_empty.notify_one_after_rmw();
+        return true;
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_BOUNDED_MPMC_QUEUE_H
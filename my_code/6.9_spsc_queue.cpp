@@ -0,0 +1,104 @@
+//
+// Created by chen on 2026/10/18.
+//
+// spsc_queue 吞吐量测试：一个生产者、一个消费者，分别测试逐个读写与批量读写，并与 threadsafe_queue 对比
+
+#include "6.7_threadsafe_queue_final.h"
+#include "6.9_spsc_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+void report(const char *name, long long total, bench_clock::time_point start, long long sum){
+    auto const us = std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - start).count();
+    long long const expected = total * (total - 1) / 2;
+    std::cout << name << ": " << us / 1000 << " ms, " << (us ? double(total) / us : 0.0) << " M ops/s"
+              << (sum == expected ? "  check." : "  MISMATCH") << std::endl;
+}
+
+int main(){
+    long long const total = 100000000;
+
+    {
+        spsc_queue<long long> q(1 << 16);
+        long long sum = 0;
+        auto const start = bench_clock::now();
+        std::thread consumer([&]{
+            long long value;
+            for(long long i = 0; i < total; ++i){
+                while(!q.try_pop(value)){
+                    std::this_thread::yield();
+                }
+                sum += value;
+            }
+        });
+        for(long long i = 0; i < total; ++i){
+            while(!q.try_push(i)){
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        report("spsc_queue try_push/try_pop", total, start, sum);
+    }
+
+    {
+        spsc_queue<long long> q(1 << 16);
+        std::size_t const batch = 256;
+        long long sum = 0;
+        auto const start = bench_clock::now();
+        std::thread consumer([&]{
+            std::vector<long long> buf(batch);
+            for(long long received = 0; received < total;){
+                std::size_t const n = q.pop_n(buf.begin(), batch);
+                if(n == 0){
+                    std::this_thread::yield();
+                }
+                for(std::size_t i = 0; i < n; ++i){
+                    sum += buf[i];
+                }
+                received += n;
+            }
+        });
+        std::vector<long long> buf(batch);
+        for(long long sent = 0; sent < total;){
+            std::size_t const want = std::min<long long>(batch, total - sent);
+            for(std::size_t i = 0; i < want; ++i){
+                buf[i] = sent + i;
+            }
+            for(std::size_t done = 0; done < want;){
+                std::size_t const n = q.push_n(buf.begin() + done, want - done);
+                if(n == 0){
+                    std::this_thread::yield();
+                }
+                done += n;
+            }
+            sent += want;
+        }
+        consumer.join();
+        report("spsc_queue push_n/pop_n    ", total, start, sum);
+    }
+
+    {
+        long long const n = total / 100;   // 太慢，只测 1% 的数据量
+        threadsafe_queue<long long> q;
+        long long sum = 0;
+        auto const start = bench_clock::now();
+        std::thread consumer([&]{
+            long long value;
+            for(long long i = 0; i < n; ++i){
+                q.wait_and_pop(value);
+                sum += value;
+            }
+        });
+        for(long long i = 0; i < n; ++i){
+            q.push(i);
+        }
+        consumer.join();
+        report("threadsafe_queue (1e6 ops) ", n, start, sum);
+    }
+    return 0;
+}
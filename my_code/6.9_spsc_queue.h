@@ -0,0 +1,116 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 单生产者单消费者（SPSC）的无等待环形缓冲区
+// 6.4 / 6.5 中的带虚节点队列只能单线程使用；当两端恰好各只有一个线程时，不需要锁也不需要CAS：
+// - 生产者只写 tail，消费者只写 head，各自独占一个缓存行
+// - 生产者缓存一份 head（head_cache），只有在缓存显示队列已满时才去读消费者的缓存行；消费者同理缓存 tail
+// - push_n / pop_n 批量读写，一次发布多个元素，进一步减少对方缓存行的读取次数
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_SPSC_QUEUE_H
+#define CPP_CONCURRENCY_IN_ACTION_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+template<class T>
+class spsc_queue{
+public:
+    // capacity 必须是2的幂
+    explicit spsc_queue(std::size_t capacity = 1024): mask(capacity - 1), buffer(new T[capacity]){
+        if(capacity < 2 || (capacity & (capacity - 1)) != 0){
+            throw std::invalid_argument("spsc_queue capacity must be a power of 2.");
+        }
+    }
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    // 以下两个函数只能由生产者调用
+    bool try_push(T value){
+        std::size_t const t = tail.load(std::memory_order_relaxed);
+        if(t - head_cache > mask){
+            head_cache = head.load(std::memory_order_acquire);
+            if(t - head_cache > mask){
+                return false;   // 队列已满
+            }
+        }
+        buffer[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 写入 [first, first + n) 中尽可能多的元素，返回实际写入的个数
+    template<class Iterator>
+    std::size_t push_n(Iterator first, std::size_t n){
+        std::size_t const t = tail.load(std::memory_order_relaxed);
+        std::size_t free_slots = mask + 1 - (t - head_cache);
+        if(free_slots < n){
+            head_cache = head.load(std::memory_order_acquire);
+            free_slots = mask + 1 - (t - head_cache);
+        }
+        std::size_t const count = n < free_slots ? n : free_slots;
+        for(std::size_t i = 0; i < count; ++i, ++first){
+            buffer[(t + i) & mask] = std::move(*first);
+        }
+        tail.store(t + count, std::memory_order_release);   // 一次发布所有元素
+        return count;
+    }
+
+    // 以下两个函数只能由消费者调用
+    bool try_pop(T &value){
+        std::size_t const h = head.load(std::memory_order_relaxed);
+        if(h == tail_cache){
+            tail_cache = tail.load(std::memory_order_acquire);
+            if(h == tail_cache){
+                return false;   // 队列为空
+            }
+        }
+        value = std::move(buffer[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 取出至多 n 个元素写到 out 中，返回实际取出的个数
+    template<class Iterator>
+    std::size_t pop_n(Iterator out, std::size_t n){
+        std::size_t const h = head.load(std::memory_order_relaxed);
+        std::size_t available = tail_cache - h;
+        if(available < n){
+            tail_cache = tail.load(std::memory_order_acquire);
+            available = tail_cache - h;
+        }
+        std::size_t const count = n < available ? n : available;
+        for(std::size_t i = 0; i < count; ++i, ++out){
+            *out = std::move(buffer[(h + i) & mask]);
+        }
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    // 并发修改时只是一个近似值，两端都可以调用
+    bool empty() const{
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const{
+        return mask + 1;
+    }
+
+private:
+    static constexpr std::size_t cache_line_size = 64;
+
+    std::size_t const mask;
+    std::unique_ptr<T[]> const buffer;
+
+    // 消费者写 head、读 tail_cache；生产者写 tail、读 head_cache
+    alignas(cache_line_size) std::atomic<std::size_t> head{0};
+    std::size_t tail_cache = 0;
+    alignas(cache_line_size) std::atomic<std::size_t> tail{0};
+    std::size_t head_cache = 0;
+    char padding[cache_line_size - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_SPSC_QUEUE_H
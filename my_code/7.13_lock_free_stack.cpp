@@ -0,0 +1,51 @@
+//
+// Created by chen on 2026/10/18.
+//
+// lock_free_stack（两种内存回收策略）与 threadsafe_stack 的对比测试：
+// 1 ~ 64 个线程，每个线程交替 push / pop，最后检查所有数据恰好被弹出一次
+
+#include "7.13_lock_free_stack.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+template<class Stack>
+void bench(const char *name, int thread_count, int ops_per_thread){
+    Stack stk;
+    std::atomic<long long> pushed_sum(0), popped_sum(0);
+    std::vector<std::thread> threads;
+    auto const start = std::chrono::steady_clock::now();
+    for(int t = 0; t < thread_count; ++t){
+        threads.emplace_back([&, t]{
+            long long pushed = 0, popped = 0;
+            for(int i = 0; i < ops_per_thread; ++i){
+                int const value = t * ops_per_thread + i;
+                stk.push(value);
+                pushed += value;
+                int result;
+                stk.pop(result);    // 每个线程先 push 后 pop，栈不会为空
+                popped += result;
+            }
+            pushed_sum += pushed;
+            popped_sum += popped;
+        });
+    }
+    for(auto &t: threads){
+        t.join();
+    }
+    auto const us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    long long const ops = 2LL * thread_count * ops_per_thread;
+    std::cout << name << " threads = " << thread_count << ": " << (us ? double(ops) / us : 0.0) << " M ops/s"
+              << (pushed_sum == popped_sum && stk.empty() ? "  check." : "  MISMATCH") << std::endl;
+}
+
+int main(){
+    int const total_ops = 1 << 20;
+    for(int threads: {1, 2, 4, 8, 16, 32, 64}){
+        bench<threadsafe_stack<int>>("threadsafe_stack              ", threads, total_ops / threads);
+        bench<lock_free_stack<int, hazard_pointer_reclamation>>("lock_free_stack (hazard)      ", threads, total_ops / threads);
+        bench<lock_free_stack<int, split_reference_count_reclamation>>("lock_free_stack (split count) ", threads, total_ops / threads);
+    }
+    return 0;
+}
@@ -0,0 +1,391 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 无锁栈的完整版本（对应书中 7.2 ~ 7.13 的逐步演进）
+// - 内存回收策略可插拔：
+//     hazard_pointer_reclamation       风险指针（7.6 ~ 7.8），每个线程维护自己的待回收列表，攒够一批再统一扫描
+//     split_reference_count_reclamation 分离引用计数（7.13），需要16字节的CAS
+// - 消除退避（elimination backoff）：CAS因竞争失败时，push 与 pop 在消除数组中直接“配对”交换数据，
+//   不再访问栈顶，竞争越激烈效果越明显
+// - 接口与 threadsafe_stack 相同：push / pop / empty，另外提供不抛异常的 try_pop
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_LOCK_FREE_STACK_H
+#define CPP_CONCURRENCY_IN_ACTION_LOCK_FREE_STACK_H
+
+#include "3.5_threadsafe_stack.h"   // empty_stack
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------- 风险指针 ----------------------------------------
+
+namespace hazard_pointer_detail{
+    unsigned const max_hazard_pointers = 128;
+
+    struct alignas(64) hazard_pointer{
+        std::atomic<std::thread::id> id;
+        std::atomic<void*> pointer;
+    };
+    inline hazard_pointer hazard_pointers[max_hazard_pointers];
+
+    // 每个线程在第一次使用时占用一个风险指针，线程退出时归还
+    class hp_owner{
+        hazard_pointer *hp;
+    public:
+        hp_owner(const hp_owner&) = delete;
+        hp_owner& operator=(const hp_owner&) = delete;
+        hp_owner(): hp(nullptr){
+            for(unsigned i = 0; i < max_hazard_pointers; ++i){
+                std::thread::id old_id;
+                if(hazard_pointers[i].id.compare_exchange_strong(old_id, std::this_thread::get_id())){
+                    hp = &hazard_pointers[i];
+                    break;
+                }
+            }
+            if(!hp){
+                throw std::runtime_error("No hazard pointers available");
+            }
+        }
+        std::atomic<void*>& get_pointer(){
+            return hp->pointer;
+        }
+        ~hp_owner(){
+            hp->pointer.store(nullptr);
+            hp->id.store(std::thread::id());
+        }
+    };
+
+    inline std::atomic<void*>& get_hazard_pointer_for_current_thread(){
+        thread_local static hp_owner hazard;
+        return hazard.get_pointer();
+    }
+
+    struct retired_node{
+        void *data;
+        void (*deleter)(void*);
+    };
+
+    // 已退出线程遗留下来、当时仍被引用的节点，由其它线程在扫描时顺带回收
+    inline std::mutex orphan_mutex;
+    inline std::vector<retired_node> orphan_nodes;
+
+    // 每个线程的待回收列表。攒够 2 * max_hazard_pointers 个节点才扫描一次，
+    // 扫描代价 O(R log H) 被均摊到每次 pop 上只有常数
+    class retire_list{
+        std::vector<retired_node> nodes;
+    public:
+        ~retire_list(){
+            scan();
+            if(!nodes.empty()){
+                std::lock_guard<std::mutex> lock(orphan_mutex);
+                orphan_nodes.insert(orphan_nodes.end(), nodes.begin(), nodes.end());
+            }
+        }
+
+        void retire(void *p, void (*deleter)(void*)){
+            nodes.push_back({p, deleter});
+            if(nodes.size() >= 2 * max_hazard_pointers){
+                scan();
+            }
+        }
+
+        void scan(){
+            {
+                std::unique_lock<std::mutex> lock(orphan_mutex, std::try_to_lock);
+                if(lock && !orphan_nodes.empty()){
+                    nodes.insert(nodes.end(), orphan_nodes.begin(), orphan_nodes.end());
+                    orphan_nodes.clear();
+                }
+            }
+            std::vector<void*> hazards;
+            hazards.reserve(max_hazard_pointers);
+            for(auto &hp: hazard_pointers){
+                if(void *p = hp.pointer.load()){
+                    hazards.push_back(p);
+                }
+            }
+            std::sort(hazards.begin(), hazards.end());
+            auto it = std::partition(nodes.begin(), nodes.end(), [&](const retired_node &n){
+                return std::binary_search(hazards.begin(), hazards.end(), n.data);    // 仍被引用的留下
+            });
+            for(auto del = it; del != nodes.end(); ++del){
+                del->deleter(del->data);
+            }
+            nodes.erase(it, nodes.end());
+        }
+    };
+
+    inline retire_list& local_retire_list(){
+        thread_local static retire_list list;
+        return list;
+    }
+
+    template<class Node>
+    void do_delete(void *p){
+        delete static_cast<Node*>(p);
+    }
+}
+
+enum class stack_pop_status{ popped, empty, contended };
+
+struct hazard_pointer_reclamation{
+    template<class T>
+    class stack_core{
+    public:
+        struct node{
+            T data;
+            node *next;
+            explicit node(T data_): data(std::move(data_)), next(nullptr){}
+        };
+
+        stack_core(): head(nullptr){}
+        ~stack_core(){
+            node *p = head.load();
+            while(p){
+                node *next = p->next;
+                delete p;
+                p = next;
+            }
+        }
+
+        bool try_push_once(node *n){
+            n->next = head.load(std::memory_order_relaxed);
+            return head.compare_exchange_strong(n->next, n, std::memory_order_release, std::memory_order_relaxed);
+        }
+
+        stack_pop_status try_pop_once(T &value){
+            std::atomic<void*> &hp = hazard_pointer_detail::get_hazard_pointer_for_current_thread();
+            node *old_head = head.load();
+            node *temp;
+            do{     // 设置风险指针后必须再读一次 head，确认节点没有在此期间被弹出
+                temp = old_head;
+                hp.store(old_head);
+                old_head = head.load();
+            }while(old_head != temp);
+            if(!old_head){
+                hp.store(nullptr);
+                return stack_pop_status::empty;
+            }
+            if(!head.compare_exchange_strong(old_head, old_head->next)){
+                hp.store(nullptr);
+                return stack_pop_status::contended;
+            }
+            hp.store(nullptr);
+            value = std::move(old_head->data);
+            hazard_pointer_detail::local_retire_list().retire(old_head, &hazard_pointer_detail::do_delete<node>);
+            return stack_pop_status::popped;
+        }
+
+        bool empty() const{
+            return head.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        std::atomic<node*> head;
+    };
+};
+
+// ---------------------------------------- 分离引用计数 ----------------------------------------
+
+struct split_reference_count_reclamation{
+    template<class T>
+    class stack_core{
+    public:
+        struct node;
+        struct counted_node_ptr{
+            int external_count;
+            node *ptr;
+        };
+        struct node{
+            T data;
+            std::atomic<int> internal_count;
+            counted_node_ptr next;
+            explicit node(T data_): data(std::move(data_)), internal_count(0), next{0, nullptr}{}
+        };
+
+        stack_core(): head(counted_node_ptr{0, nullptr}){}
+        ~stack_core(){
+            node *p = head.load().ptr;
+            while(p){
+                node *next = p->next.ptr;
+                delete p;
+                p = next;
+            }
+        }
+
+        bool try_push_once(node *n){
+            counted_node_ptr new_node{1, n};
+            n->next = head.load(std::memory_order_relaxed);
+            return head.compare_exchange_strong(n->next, new_node, std::memory_order_release, std::memory_order_relaxed);
+        }
+
+        stack_pop_status try_pop_once(T &value){
+            counted_node_ptr old_head = head.load(std::memory_order_relaxed);
+            increase_head_count(old_head);
+            node * const ptr = old_head.ptr;
+            if(!ptr){
+                return stack_pop_status::empty;
+            }
+            if(head.compare_exchange_strong(old_head, ptr->next, std::memory_order_relaxed)){
+                value = std::move(ptr->data);
+                int const count_increase = old_head.external_count - 2;
+                if(ptr->internal_count.fetch_add(count_increase, std::memory_order_release) == -count_increase){
+                    delete ptr;
+                }
+                return stack_pop_status::popped;
+            }
+            if(ptr->internal_count.fetch_add(-1, std::memory_order_relaxed) == 1){
+                ptr->internal_count.load(std::memory_order_acquire);
+                delete ptr;
+            }
+            return stack_pop_status::contended;
+        }
+
+        bool empty() const{
+            return head.load(std::memory_order_acquire).ptr == nullptr;
+        }
+
+    private:
+        std::atomic<counted_node_ptr> head;
+
+        void increase_head_count(counted_node_ptr &old_counter){
+            counted_node_ptr new_counter;
+            do{
+                new_counter = old_counter;
+                ++new_counter.external_count;
+            }while(!head.compare_exchange_strong(old_counter, new_counter,
+                                                 std::memory_order_acquire, std::memory_order_relaxed));
+            old_counter.external_count = new_counter.external_count;
+        }
+    };
+};
+
+// ---------------------------------------- 无锁栈 ----------------------------------------
+
+template<class T, class Reclamation = hazard_pointer_reclamation>
+class lock_free_stack{
+public:
+    lock_free_stack(){
+        for(auto &slot: elimination){
+            slot.offer.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    lock_free_stack(const lock_free_stack&) = delete;
+    lock_free_stack& operator=(const lock_free_stack&) = delete;
+
+    void push(T value){
+        node *n = new node(std::move(value));
+        for(unsigned backoff = 1; ; backoff = std::min(backoff * 2, max_backoff)){
+            if(core.try_push_once(n) || try_eliminate_push(n, backoff)){
+                return;
+            }
+        }
+    }
+
+    bool try_pop(T &value){
+        for(unsigned backoff = 1; ; backoff = std::min(backoff * 2, max_backoff)){
+            switch(core.try_pop_once(value)){
+                case stack_pop_status::popped:
+                    return true;
+                case stack_pop_status::empty:
+                    return false;
+                case stack_pop_status::contended:
+                    if(try_eliminate_pop(value, backoff)){
+                        return true;
+                    }
+            }
+        }
+    }
+
+    std::shared_ptr<T> pop(){
+        T value;
+        if(!try_pop(value)){
+            throw empty_stack();
+        }
+        return std::make_shared<T>(std::move(value));
+    }
+
+    void pop(T &result){
+        if(!try_pop(result)){
+            throw empty_stack();
+        }
+    }
+
+    bool empty() const{
+        return core.empty();
+    }
+
+private:
+    using core_type = typename Reclamation::template stack_core<T>;
+    using node = typename core_type::node;
+
+    static constexpr unsigned elimination_size = 16;
+    static constexpr unsigned max_backoff = 64;
+
+    // 消除数组的槽位：push 把尚未入栈的节点挂在这里等待配对，pop 用CAS把它换成 taken() 即完成一次交换。
+    // 节点从未进入栈中，所以不需要任何内存回收机制保护
+    struct alignas(64) elimination_slot{
+        std::atomic<node*> offer;
+    };
+
+    core_type core;
+    elimination_slot elimination[elimination_size];
+
+    static unsigned random_slot(){
+        thread_local std::uint32_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1u;
+        state ^= state << 13;   // xorshift32
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state % elimination_size;
+    }
+
+    static void spin(unsigned rounds){
+        for(unsigned i = 0; i < rounds; ++i){
+            std::atomic_signal_fence(std::memory_order_seq_cst);    // 防止空循环被优化掉
+        }
+    }
+
+    // 表示“节点已被 pop 取走”的标记值。只有挂出节点的 push 线程才能把槽位重新置空，
+    // 这样槽位不会在它不知情的情况下被别人复用，避免了 ABA 问题
+    static node* taken(){
+        static char tag;
+        return reinterpret_cast<node*>(&tag);
+    }
+
+    bool try_eliminate_push(node *n, unsigned backoff){
+        elimination_slot &slot = elimination[random_slot()];
+        node *expected = nullptr;
+        if(!slot.offer.compare_exchange_strong(expected, n, std::memory_order_release, std::memory_order_relaxed)){
+            spin(backoff);
+            return false;
+        }
+        spin(backoff * 16);     // 等待 pop 配对
+        expected = n;
+        if(slot.offer.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed, std::memory_order_relaxed)){
+            return false;       // 撤回成功，没有配对
+        }
+        slot.offer.store(nullptr, std::memory_order_relaxed);   // 已被取走（槽位为 taken），复位槽位
+        return true;
+    }
+
+    bool try_eliminate_pop(T &value, unsigned backoff){
+        elimination_slot &slot = elimination[random_slot()];
+        node *n = slot.offer.load(std::memory_order_relaxed);
+        if(n && n != taken()
+           && slot.offer.compare_exchange_strong(n, taken(), std::memory_order_acquire, std::memory_order_relaxed)){
+            value = std::move(n->data);
+            delete n;
+            return true;
+        }
+        spin(backoff);
+        return false;
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_LOCK_FREE_STACK_H
@@ -0,0 +1,174 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 基于纪元的内存回收（epoch-based reclamation）
+// 风险指针每个线程只能保护固定几个指针，不适合跳表、B+树这类一次遍历要经过许多节点、还要支持范围迭代的结构。
+// 纪元回收保护的是一段“临界区”而不是单个指针：
+// - 全局纪元 global_epoch 单调递增；线程进入临界区（epoch_guard）时登记当前纪元，离开时登记为静止
+// - 被摘除的节点交给 epoch_retire，记录摘除时的纪元 e
+// - 只有所有处于临界区的线程都已登记为当前纪元时，全局纪元才能加一；
+//   当全局纪元 >= e + 2 时，不可能还有线程持有该节点的指针，可以释放
+// 代价：临界区内的读操作没有任何额外的原子写；但一个长时间不退出临界区的线程会阻止所有回收
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_EPOCH_RECLAMATION_H
+#define CPP_CONCURRENCY_IN_ACTION_EPOCH_RECLAMATION_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace epoch_detail{
+    unsigned const max_threads = 128;
+    std::uint64_t const quiescent = ~std::uint64_t(0);     // 不在临界区内
+    unsigned const collect_threshold = 64;                 // 每个线程攒够这么多待回收节点才尝试推进纪元
+
+    struct alignas(64) epoch_record{
+        std::atomic<std::thread::id> id;
+        std::atomic<std::uint64_t> epoch{quiescent};
+    };
+    inline epoch_record records[max_threads];
+    alignas(64) inline std::atomic<std::uint64_t> global_epoch{0};
+
+    struct retired_node{
+        void *data;
+        void (*deleter)(void*);
+        std::uint64_t epoch;
+    };
+
+    // 已退出线程遗留下来、当时还不能释放的节点，由其它线程在回收时顺带处理
+    inline std::mutex orphan_mutex;
+    inline std::vector<retired_node> orphan_nodes;
+
+    // 所有处于临界区的线程都已登记为当前纪元时，把全局纪元加一
+    inline void try_advance(){
+        std::uint64_t e = global_epoch.load(std::memory_order_seq_cst);
+        for(auto &r: records){
+            std::uint64_t const local = r.epoch.load(std::memory_order_seq_cst);
+            if(local != quiescent && local != e){
+                return;
+            }
+        }
+        global_epoch.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+    }
+
+    class thread_state{
+        epoch_record *rec;
+        unsigned depth;     // 允许嵌套进入临界区
+        std::vector<retired_node> limbo;
+    public:
+        thread_state(const thread_state&) = delete;
+        thread_state& operator=(const thread_state&) = delete;
+        thread_state(): rec(nullptr), depth(0){
+            for(unsigned i = 0; i < max_threads; ++i){
+                std::thread::id old_id;
+                if(records[i].id.compare_exchange_strong(old_id, std::this_thread::get_id())){
+                    rec = &records[i];
+                    break;
+                }
+            }
+            if(!rec){
+                throw std::runtime_error("No epoch records available");
+            }
+        }
+        ~thread_state(){
+            // 本线程已静止，其它线程也都静止时，推进两次纪元就能释放全部节点
+            for(int i = 0; i < 3 && !limbo.empty(); ++i){
+                collect();
+            }
+            if(!limbo.empty()){
+                std::lock_guard<std::mutex> lock(orphan_mutex);
+                orphan_nodes.insert(orphan_nodes.end(), limbo.begin(), limbo.end());
+            }
+            rec->epoch.store(quiescent);
+            rec->id.store(std::thread::id());
+        }
+
+        void enter(){
+            if(depth++ != 0){
+                return;
+            }
+            // 登记之后再确认一次全局纪元没有变化，否则推进纪元的线程可能没看到这次登记
+            std::uint64_t e = global_epoch.load(std::memory_order_seq_cst);
+            for(;;){
+                rec->epoch.store(e, std::memory_order_seq_cst);
+                std::uint64_t const now = global_epoch.load(std::memory_order_seq_cst);
+                if(now == e){
+                    break;
+                }
+                e = now;
+            }
+        }
+
+        void leave(){
+            if(--depth == 0){
+                rec->epoch.store(quiescent, std::memory_order_release);
+            }
+        }
+
+        // 调用前节点必须已经无法从数据结构中访问到
+        void retire(void *p, void (*deleter)(void*)){
+            limbo.push_back({p, deleter, global_epoch.load(std::memory_order_seq_cst)});
+            if(limbo.size() >= collect_threshold){
+                collect();
+            }
+        }
+
+        void collect(){
+            {
+                std::unique_lock<std::mutex> lock(orphan_mutex, std::try_to_lock);
+                if(lock && !orphan_nodes.empty()){
+                    limbo.insert(limbo.end(), orphan_nodes.begin(), orphan_nodes.end());
+                    orphan_nodes.clear();
+                }
+            }
+            try_advance();
+            std::uint64_t const e = global_epoch.load(std::memory_order_seq_cst);
+            std::size_t kept = 0;
+            for(auto &n: limbo){
+                if(n.epoch + 2 <= e){
+                    n.deleter(n.data);
+                }else{
+                    limbo[kept++] = n;
+                }
+            }
+            limbo.resize(kept);
+        }
+    };
+
+    inline thread_state& local_state(){
+        thread_local static thread_state state;
+        return state;
+    }
+
+    template<class Node>
+    void do_delete(void *p){
+        delete static_cast<Node*>(p);
+    }
+}
+
+// 纪元临界区。在其中读到的节点指针在离开之前都不会被释放；同一线程可以嵌套
+class epoch_guard{
+public:
+    epoch_guard(){
+        epoch_detail::local_state().enter();
+    }
+    ~epoch_guard(){
+        epoch_detail::local_state().leave();
+    }
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+};
+
+inline void epoch_retire(void *p, void (*deleter)(void*)){
+    epoch_detail::local_state().retire(p, deleter);
+}
+
+template<class T>
+void epoch_retire(T *p){
+    epoch_retire(p, &epoch_detail::do_delete<T>);
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_EPOCH_RECLAMATION_H
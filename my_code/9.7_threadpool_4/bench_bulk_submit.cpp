@@ -0,0 +1,53 @@
+//
+// Created by chen on 2026/10/18.
+//
+// bulk_submit 基准测试：一次性扇出大量同构小任务，对比逐个 submit 与 bulk_submit 的吞吐量
+
+#include "threadpool.h"
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+int main(){
+    thread_pool tp;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for(int const task_count: {10000, 100000}){
+        std::vector<int> data(task_count);
+        std::iota(data.begin(), data.end(), 0);
+        std::vector<long long> out(task_count);
+
+        // 逐个 submit：每个任务一个 packaged_task + future + 一次入队
+        auto const start1 = bench_clock::now();
+        std::vector<std::future<void>> futures;
+        futures.reserve(task_count);
+        for(int i = 0; i < task_count; ++i){
+            futures.push_back(tp.submit([&out, &data, i]{
+                out[i] = 1LL * data[i] * data[i];
+            }));
+        }
+        for(auto &f: futures){
+            f.get();
+        }
+        auto const us1 = std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - start1).count();
+        long long const sum1 = std::accumulate(out.begin(), out.end(), 0LL);
+
+        // bulk_submit：一次入队，一个完成句柄
+        std::fill(out.begin(), out.end(), 0);
+        auto const start2 = bench_clock::now();
+        tp.bulk_submit(data.begin(), data.end(), [&out](int &x){
+            out[x] = 1LL * x * x;
+        }).get();
+        auto const us2 = std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - start2).count();
+        long long const sum2 = std::accumulate(out.begin(), out.end(), 0LL);
+
+        std::cout << task_count << " tasks: submit loop " << us1 << " us ("
+                  << 1000.0 * task_count / std::max<long long>(us1, 1) << " k tasks/s), bulk_submit " << us2 << " us ("
+                  << 1000.0 * task_count / std::max<long long>(us2, 1) << " k tasks/s)"
+                  << (sum1 == sum2 ? "  check." : "  MISMATCH") << std::endl;
+    }
+    return 0;
+}
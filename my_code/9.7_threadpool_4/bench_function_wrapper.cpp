@@ -0,0 +1,335 @@
+//
+// Created by chen on 2026/10/18.
+//
+// function_wrapper 微基准测试：对比旧版（每个任务都 new 一个 impl_type）与带小缓冲区优化的新版
+// 1. 单独封装任务时，每个任务的堆分配次数（通过替换全部全局 operator new / delete 计数）
+// 2. 经过真实的 thread_pool 时每次 submit / post 的堆分配次数，包括池外线程提交与工作线程内部提交
+// 3. 经过 thread_pool 从提交到执行的延迟
+// 4. 用左值构造时复制可调用对象，原对象保持不变
+
+#include "threadpool.h"
+#include "function_wrapper.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+static std::atomic<std::size_t> allocation_count(0);
+
+// 替换完整的一组分配/释放函数（普通、数组、nothrow、对齐以及带大小的版本），全部基于 malloc / free，
+// 这样无论哪种 new 分配的内存交给哪种 delete，释放方式都一致
+static void* counted_alloc(std::size_t n, std::size_t align){
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    n = n ? n : 1;
+    if(align <= alignof(std::max_align_t)){
+        return std::malloc(n);
+    }
+    return std::aligned_alloc(align, (n + align - 1) / align * align);
+}
+
+static void* counted_alloc_or_throw(std::size_t n, std::size_t align){
+    if(void *p = counted_alloc(n, align)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n){
+    return counted_alloc_or_throw(n, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t n){
+    return counted_alloc_or_throw(n, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t n, std::align_val_t align){
+    return counted_alloc_or_throw(n, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t n, std::align_val_t align){
+    return counted_alloc_or_throw(n, static_cast<std::size_t>(align));
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept{
+    return counted_alloc(n, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept{
+    return counted_alloc(n, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t n, std::align_val_t align, const std::nothrow_t&) noexcept{
+    return counted_alloc(n, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t n, std::align_val_t align, const std::nothrow_t&) noexcept{
+    return counted_alloc(n, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *p) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t&) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t&) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t&) noexcept{
+    std::free(p);
+}
+
+// 旧版函数封装器，作为对照
+class legacy_function_wrapper{
+public:
+    template<class Function>
+    legacy_function_wrapper(Function &&f): impl(new impl_type<Function>(std::move(f))){}
+    legacy_function_wrapper() = default;
+    legacy_function_wrapper(legacy_function_wrapper &&other): impl(std::move(other.impl)){}
+    legacy_function_wrapper& operator=(legacy_function_wrapper &&other){
+        impl = std::move(other.impl);
+        return *this;
+    }
+    legacy_function_wrapper(const legacy_function_wrapper&) = delete;
+    legacy_function_wrapper(legacy_function_wrapper&) = delete;
+    legacy_function_wrapper& operator=(const legacy_function_wrapper&) = delete;
+
+    void operator()(){
+        impl->call();
+    }
+
+private:
+    struct impl_base{
+        virtual void call() = 0;
+        virtual ~impl_base(){}
+    };
+
+    std::unique_ptr<impl_base> impl;
+
+    template<class Function>
+    struct impl_type: impl_base{
+        Function f;
+        explicit impl_type(Function &&f_): f(std::move(f_)){}
+        void call(){
+            f();
+        }
+    };
+};
+
+template<class Wrapper>
+void bench_allocations(const char *name, int task_count){
+    std::vector<Wrapper> tasks;
+    tasks.reserve(task_count);
+    long long sum = 0;
+
+    // 只封装小 lambda
+    std::size_t before = allocation_count.load();
+    for(int i = 0; i < task_count; ++i){
+        tasks.emplace_back([i, &sum]{ sum += i * i; });
+    }
+    for(auto &t: tasks){
+        t();
+    }
+    tasks.clear();
+    double const lambda_allocs = double(allocation_count.load() - before) / task_count;
+
+    // 与 thread_pool::submit 相同：packaged_task + future（共享状态本身仍需要一次分配）
+    std::vector<std::future<int>> futures;
+    futures.reserve(task_count);
+    before = allocation_count.load();
+    for(int i = 0; i < task_count; ++i){
+        std::packaged_task<int()> task([i]{ return i * i; });
+        futures.push_back(task.get_future());
+        tasks.emplace_back(std::move(task));
+    }
+    for(auto &t: tasks){
+        t();
+    }
+    for(auto &f: futures){
+        sum += f.get();
+    }
+    double const task_allocs = double(allocation_count.load() - before) / task_count;
+
+    std::cout << name << ": allocations per lambda = " << lambda_allocs
+              << ", per packaged_task = " << task_allocs << "  (" << sum << ")" << std::endl;
+}
+
+// 等待 counter 达到 target，期间当前线程（可能是池外线程）不参与执行任务
+static void wait_for(std::atomic<int> &counter, int target){
+    while(counter.load(std::memory_order_acquire) < target){
+        std::this_thread::yield();
+    }
+}
+
+// 经过 thread_pool 的分配次数：池外线程 submit（packaged_task 的共享状态与结果对象仍需两次分配）、池外线程 post，
+// 以及工作线程在任务内部 post 子任务（进入本地队列，可能被其它线程窃取）。
+// 每种方式先完整跑一轮预热，让队列的节点池与数组扩容到位，第二轮才计数
+void bench_pool_allocations(int task_count){
+    thread_pool tp(4);
+    std::atomic<int> finished(0);
+    long long sum = 0;
+
+    auto external_submit = [&]{
+        std::vector<std::future<int>> futures;
+        futures.reserve(task_count);
+        std::size_t const before = allocation_count.load();
+        for(int i = 0; i < task_count; ++i){
+            futures.push_back(tp.submit([i]{ return i & 7; }));
+        }
+        std::size_t const allocs = allocation_count.load() - before;
+        for(auto &f: futures){
+            sum += f.get();
+        }
+        return double(allocs) / task_count;
+    };
+
+    auto external_post = [&]{
+        finished = 0;
+        std::size_t const before = allocation_count.load();
+        for(int i = 0; i < task_count; ++i){
+            tp.post([&finished]{ finished.fetch_add(1, std::memory_order_release); });
+        }
+        wait_for(finished, task_count);
+        return double(allocation_count.load() - before) / task_count;
+    };
+
+    auto worker_post = [&]{
+        finished = 0;
+        std::size_t const before = allocation_count.load();
+        tp.post([&]{
+            for(int i = 0; i < task_count; ++i){
+                tp.post([&finished]{ finished.fetch_add(1, std::memory_order_release); });
+            }
+        });
+        wait_for(finished, task_count);
+        return double(allocation_count.load() - before) / task_count;
+    };
+
+    external_submit();
+    double const submit_allocs = external_submit();
+    external_post();
+    double const post_allocs = external_post();
+    worker_post();
+    double const worker_allocs = worker_post();
+
+    std::cout << "thread_pool: allocations per external submit = " << submit_allocs
+              << ", per external post = " << post_allocs
+              << ", per worker post = " << worker_allocs << "  (" << sum << ")";
+    if(submit_allocs < 2.01 && post_allocs < 0.01 && worker_allocs < 0.01){
+        std::cout << "  check.";
+    }else{
+        std::cout << "  MISMATCH";
+    }
+    std::cout << std::endl;
+}
+
+// 经过 thread_pool 从提交到开始执行的平均延迟：池外线程连续提交 task_count 个任务，每个任务记录自己的延迟
+void bench_pool_latency(int task_count){
+    using clock = std::chrono::steady_clock;
+    thread_pool tp(4);
+    std::atomic<long long> total_ns(0);
+    std::atomic<int> finished(0);
+
+    auto const start = clock::now();
+    for(int i = 0; i < task_count; ++i){
+        auto const submitted = clock::now();
+        tp.post([submitted, &total_ns, &finished]{
+            total_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - submitted).count(),
+                               std::memory_order_relaxed);
+            finished.fetch_add(1, std::memory_order_release);
+        });
+    }
+    wait_for(finished, task_count);
+    auto const post_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+    long long const post_latency = total_ns.exchange(0) / task_count;
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(task_count);
+    auto const submit_start = clock::now();
+    for(int i = 0; i < task_count; ++i){
+        auto const submitted = clock::now();
+        futures.push_back(tp.submit([submitted, &total_ns]{
+            total_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - submitted).count(),
+                               std::memory_order_relaxed);
+        }));
+    }
+    for(auto &f: futures){
+        f.get();
+    }
+    auto const submit_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - submit_start).count();
+
+    std::cout << "thread_pool: average post-to-run latency = " << post_latency << " ns, total " << post_elapsed << " ms; "
+              << "submit-to-run latency = " << total_ns.load() / task_count << " ns, total " << submit_elapsed << " ms"
+              << std::endl;
+}
+
+// 左值被复制，右值被移动；用一个封装器构造另一个时走移动构造
+void check_lvalue_copy(){
+    std::vector<int> data(100, 1);
+    std::size_t seen = 0;
+    auto f = [data, &seen]{ seen = data.size(); };
+    function_wrapper w(f);
+    w();
+    std::size_t const wrapped = seen;
+    f();
+    function_wrapper moved(std::move(w));
+    moved();
+    std::cout << "lvalue wrapped: wrapper saw " << wrapped << ", original saw " << seen;
+    if(wrapped == 100 && seen == 100 && !w && moved){
+        std::cout << "  check.";
+    }
+    std::cout << std::endl;
+}
+
+int main(){
+    int const task_count = 1000000;
+    check_lvalue_copy();
+    std::cout << "sizeof(legacy_function_wrapper) = " << sizeof(legacy_function_wrapper)
+              << ", sizeof(function_wrapper) = " << sizeof(function_wrapper) << std::endl;
+
+    bench_allocations<legacy_function_wrapper>("legacy", task_count);
+    bench_allocations<function_wrapper>("sbo   ", task_count);
+
+    bench_pool_allocations(task_count);
+    bench_pool_latency(task_count);
+    return 0;
+}
@@ -0,0 +1,133 @@
+//
+// Created by chen on 2026/10/18.
+//
+// thread_pool 空闲策略基准测试
+// 1. 空闲时的CPU占用：线程池无任务运行一段时间，统计进程消耗的CPU时间
+// 2. 唤醒延迟：分别在线程池繁忙（工作线程仍在自旋）和空闲（工作线程已睡眠）时提交任务，统计从 submit 到开始执行的时间
+// 3. 突发任务：8 个工作线程全部睡眠后，先执行一个空任务，再连续提交 64 个各睡眠 10ms 的任务，
+//    唤醒应当逐个传递，任务分散到全部 8 个线程上，总时间约 80ms
+// 4. 构造失败：创建第 3 个工作线程时让 pthread_create 失败，已经启动并睡眠的工作线程应被唤醒，构造函数抛出异常而不是卡住
+
+#include "threadpool.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <dlfcn.h>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <set>
+#include <system_error>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+// 小于 0 时不限制；否则每创建一个线程减 1，减到 0 后 pthread_create 返回 EAGAIN（std::thread 构造时抛出 system_error）
+static std::atomic<int> thread_create_budget(-1);
+
+extern "C" int pthread_create(pthread_t *thread, const pthread_attr_t *attr, void *(*start)(void*), void *arg){
+    using real_type = int (*)(pthread_t*, const pthread_attr_t*, void *(*)(void*), void*);
+    static real_type const real = reinterpret_cast<real_type>(dlsym(RTLD_NEXT, "pthread_create"));
+    int budget = thread_create_budget.load();
+    while(budget > 0 && !thread_create_budget.compare_exchange_weak(budget, budget - 1)){
+    }
+    if(budget == 0){
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));    // 让已经启动的工作线程先进入睡眠
+        return EAGAIN;
+    }
+    return real(thread, attr, start, arg);
+}
+
+long long wakeup_latency_ns(thread_pool &tp, std::chrono::microseconds gap, int rounds){
+    std::vector<long long> samples;
+    samples.reserve(rounds);
+    for(int i = 0; i < rounds; ++i){
+        std::this_thread::sleep_for(gap);
+        auto const submitted = bench_clock::now();
+        auto f = tp.submit([submitted]{
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - submitted).count();
+        });
+        samples.push_back(f.get());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];     // 中位数
+}
+
+void burst_spread(){
+    thread_pool tp(8);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    tp.submit([]{}).get();
+
+    std::mutex m;
+    std::set<std::thread::id> ids;
+    std::vector<std::future<void>> results;
+    auto const start = bench_clock::now();
+    for(int i = 0; i < 64; ++i){
+        results.push_back(tp.submit([&]{
+            {
+                std::lock_guard<std::mutex> lk(m);
+                ids.insert(std::this_thread::get_id());
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }));
+    }
+    for(auto &f: results){
+        f.get();
+    }
+    auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - start).count();
+    std::cout << "burst of 64 x 10 ms tasks on 8 parked workers: " << ms << " ms on " << ids.size() << " workers";
+    if(ids.size() == 8 && ms < 160){
+        std::cout << "  check.";
+    }
+    std::cout << std::endl;
+}
+
+void constructor_failure(){
+    static std::atomic<bool> finished(false);
+    std::thread watchdog([]{
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        if(finished){
+            return;
+        }
+        std::cout << "thread_pool constructor hung after a failed thread creation  MISMATCH" << std::endl;
+        std::_Exit(1);
+    });
+    watchdog.detach();
+    thread_create_budget = 3;   // 时间轮线程与前两个工作线程
+    bool thrown = false;
+    try{
+        thread_pool tp(4);
+    }catch (const std::system_error&){
+        thrown = true;
+    }
+    thread_create_budget = -1;
+    finished = true;
+    std::cout << "thread_pool constructor with a failing thread creation: "
+              << (thrown ? "threw and joined the started workers" : "did not throw");
+    std::cout << (thrown ? "  check." : "  MISMATCH") << std::endl;
+}
+
+int main(){
+    constructor_failure();
+    burst_spread();
+
+    thread_pool tp;
+
+    // 等待所有工作线程进入睡眠，然后统计一秒内的CPU时间
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::clock_t const cpu_start = std::clock();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    double const idle_cpu_ms = 1000.0 * double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    std::cout << "idle CPU time over 1 s (" << std::thread::hardware_concurrency() << " workers): "
+              << idle_cpu_ms << " ms" << std::endl;
+
+    // 间隔很短：工作线程还在自旋阶段
+    std::cout << "median wakeup latency, busy pool: "
+              << wakeup_latency_ns(tp, std::chrono::microseconds(0), 10000) << " ns" << std::endl;
+    // 间隔较长：工作线程已经睡眠，需要经由 futex 唤醒
+    std::cout << "median wakeup latency, parked pool: "
+              << wakeup_latency_ns(tp, std::chrono::microseconds(5000), 200) << " ns" << std::endl;
+    return 0;
+}
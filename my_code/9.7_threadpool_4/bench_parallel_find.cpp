@@ -0,0 +1,145 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 并行查找基准测试：
+// 1. 正确性：与 std::find / std::find_if / std::mismatch / std::any_of / std::all_of 的结果相同（4 个工作线程，
+//    多个匹配时返回最靠前的），浮点数的 NaN 与 ±0，谓词抛出的异常
+// 2. 一亿个 int 中查找位于不同位置的值：std::find、8.9 中每线程一整块且逐元素读 seq_cst 标志的版本、parallel_find
+
+#include "parallel_find.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+// 8.9_parallel_find_1.cpp 中的实现
+template<class Iterator, class MatchType>
+Iterator block_find(Iterator first, Iterator last, MatchType match){
+    auto find_element = [](Iterator begin, Iterator end, MatchType match, std::promise<Iterator> *result, std::atomic<bool> *done_flag){
+        for(; (begin != end) && !done_flag->load(); ++begin){
+            if(*begin == match){
+                result->set_value(begin);
+                done_flag->store(true);
+                return;
+            }
+        }
+    };
+    unsigned long const length = std::distance(first, last);
+    unsigned long const hardware_threads = std::thread::hardware_concurrency();
+    unsigned long const num_threads = std::min<unsigned long>(hardware_threads != 0 ? hardware_threads : 2, (length + 24) / 25);
+    unsigned long const block_size = length / num_threads;
+    std::promise<Iterator> result;
+    std::atomic<bool> done_flag = false;
+    {
+        std::vector<std::jthread> threads(num_threads - 1);
+        Iterator block_start = first;
+        for(auto &t: threads){
+            Iterator block_end = block_start + block_size;
+            t = std::jthread(find_element, block_start, block_end, match, &result, &done_flag);
+            block_start = block_end;
+        }
+        find_element(block_start, last, match, &result, &done_flag);
+    }
+    if(!done_flag.load()){
+        return last;
+    }
+    return result.get_future().get();
+}
+
+int main(){
+    bool ok = true;
+
+    // 1. 正确性
+    {
+        thread_pool tp(4);
+        std::mt19937 engine(9);
+        for(std::size_t n: {std::size_t(0), std::size_t(1), std::size_t(100), std::size_t(50000), std::size_t(1000003)}){
+            std::vector<int> v(n);
+            for(auto &x: v){
+                x = int(engine() % 100000);
+            }
+            for(int target: {-1, 0, 7, 99999, v.empty() ? 1 : v[n / 2], v.empty() ? 1 : v[n - 1]}){
+                ok = ok && parallel_find(tp, v.begin(), v.end(), target) == std::find(v.begin(), v.end(), target);
+                ok = ok && parallel_find(tp, v.begin(), v.end(), (long long)target) == std::find(v.begin(), v.end(), (long long)target);
+                auto const pred = [target](int x){ return x > target; };
+                ok = ok && parallel_find_if(tp, v.begin(), v.end(), pred) == std::find_if(v.begin(), v.end(), pred);
+                ok = ok && parallel_find_if_not(tp, v.begin(), v.end(), pred) == std::find_if_not(v.begin(), v.end(), pred);
+                ok = ok && parallel_any_of(tp, v.begin(), v.end(), pred) == std::any_of(v.begin(), v.end(), pred);
+                ok = ok && parallel_all_of(tp, v.begin(), v.end(), pred) == std::all_of(v.begin(), v.end(), pred);
+                ok = ok && parallel_none_of(tp, v.begin(), v.end(), pred) == std::none_of(v.begin(), v.end(), pred);
+            }
+            std::vector<int> w = v;
+            for(std::size_t at: {n * 3 / 4, n / 3, n / 2}){
+                if(at < n){
+                    w[at] ^= 1;
+                }
+                ok = ok && parallel_mismatch(tp, v.begin(), v.end(), w.begin()) == std::mismatch(v.begin(), v.end(), w.begin());
+                auto const same_parity = [](int a, int b){ return a % 2 == b % 2; };
+                ok = ok && parallel_mismatch(tp, v.begin(), v.end(), w.begin(), same_parity)
+                           == std::mismatch(v.begin(), v.end(), w.begin(), same_parity);
+            }
+        }
+        std::vector<double> d(300000, 1.0);
+        d[200000] = -0.0;
+        d[250000] = std::numeric_limits<double>::quiet_NaN();
+        ok = ok && parallel_find(tp, d.begin(), d.end(), 0.0) - d.begin() == 200000;
+        ok = ok && parallel_find(tp, d.begin(), d.end(), std::numeric_limits<double>::quiet_NaN()) == d.end();
+        std::vector<double> d2 = d;
+        ok = ok && parallel_mismatch(tp, d.begin(), d.end(), d2.begin()).first - d.begin() == 250000;
+        std::vector<char> text(1000000, 'a');
+        text[777777] = 'b';
+        ok = ok && parallel_find(tp, text.begin(), text.end(), 'b') - text.begin() == 777777;
+
+        bool caught = false;
+        try{
+            std::vector<int> v(1000000, 0);
+            parallel_find_if(tp, v.begin(), v.end(), [&v](const int &x){
+                if(&x - v.data() == 600000){
+                    throw std::runtime_error("boom");
+                }
+                return false;
+            });
+        }catch (const std::runtime_error &){
+            caught = true;
+        }
+        ok = ok && caught;
+        std::cout << "correctness" << (ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+
+    // 2. 一亿个 int
+    {
+        thread_pool tp;
+        std::size_t const n = 100000000;
+        std::vector<int> v(n, 0);
+        auto const us = [](auto d){ return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+        std::cout << "find in " << n << " ints, " << tp.thread_count() << " workers (us):" << std::endl;
+        std::cout << "  position     std::find    block (8.9)    parallel_find" << std::endl;
+        for(double where: {0.0001, 0.1, 0.5, 0.9, -1.0}){
+            std::size_t const pos = where < 0 ? n : std::size_t(n * where);
+            if(pos < n){
+                v[pos] = 1;
+            }
+            auto const t0 = bench_clock::now();
+            auto const r1 = std::find(v.begin(), v.end(), 1);
+            auto const t1 = bench_clock::now();
+            auto const r2 = block_find(v.begin(), v.end(), 1);
+            auto const t2 = bench_clock::now();
+            auto const r3 = parallel_find(tp, v.begin(), v.end(), 1);
+            auto const t3 = bench_clock::now();
+            bool const find_ok = r1 - v.begin() == std::ptrdiff_t(pos) && r2 == r1 && r3 == r1;
+            ok = ok && find_ok;
+            std::cout << "  " << (pos < n ? std::to_string(pos) : std::string("absent  ")) << "\t" << us(t1 - t0) << "\t"
+                      << us(t2 - t1) << "\t" << us(t3 - t2) << (find_ok ? "  check." : "  MISMATCH") << std::endl;
+            if(pos < n){
+                v[pos] = 0;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 并行前缀和基准测试：
+// 1. 正确性：inclusive/exclusive、带初值与不带初值、原地扫描、自定义结合律运算（max、不满足交换律的字符串拼接）、
+//    非连续存储的随机访问迭代器（std::deque）、子任务抛出的异常。使用 4 个工作线程，以覆盖多块的路径
+// 2. 一亿个 int 的前缀和：std::inclusive_scan、8.11 中用 promise/future 串行传递进位的版本、两遍扫描的 parallel_inclusive_scan
+
+#include "parallel_scan.h"
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+// 8.11_parallel_partial_sum.cpp 中的实现，块的进位通过 promise/future 依次传递
+template<class Iterator>
+void future_chain_partial_sum(Iterator first, Iterator last){
+    using value_type = typename Iterator::value_type;
+    auto process_chunk = [](Iterator begin, Iterator last, std::future<value_type> *previous_end_value,
+                            std::promise<value_type> *end_value){
+        Iterator end = last;
+        ++end;
+        std::partial_sum(begin, end, begin);
+        if(previous_end_value){
+            value_type addend = previous_end_value->get();
+            *last += addend;
+            if(end_value){
+                end_value->set_value(*last);
+            }
+            std::for_each(begin, last, [addend](value_type &item){
+                item += addend;
+            });
+        }else if(end_value){
+            end_value->set_value(*last);
+        }
+    };
+    std::size_t const length = std::distance(first, last);
+    std::size_t const hardware_threads = std::thread::hardware_concurrency();
+    std::size_t const num_threads = std::min<std::size_t>(hardware_threads != 0 ? hardware_threads : 2, (length + 24) / 25);
+    std::size_t const block_size = length / num_threads;
+    std::vector<std::promise<value_type>> end_values(num_threads - 1);
+    std::vector<std::future<value_type>> prev_end_values;
+    prev_end_values.reserve(num_threads - 1);
+    Iterator block_start = first;
+    std::vector<std::jthread> threads(num_threads - 1);
+    for(std::size_t i = 0; i < num_threads - 1; ++i){
+        Iterator block_last = block_start;
+        std::advance(block_last, block_size - 1);
+        threads[i] = std::jthread(process_chunk, block_start, block_last, i != 0 ? &prev_end_values[i - 1] : nullptr, &end_values[i]);
+        block_start = block_last;
+        ++block_start;
+        prev_end_values.emplace_back(end_values[i].get_future());
+    }
+    Iterator final_element = block_start;
+    std::advance(final_element, std::distance(block_start, last) - 1);
+    process_chunk(block_start, final_element, num_threads > 1 ? &prev_end_values.back() : nullptr, nullptr);
+}
+
+template<class Function>
+double best_seconds(Function f, int repeat = 3){
+    double best = 1e9;
+    for(int r = 0; r < repeat; ++r){
+        auto const start = bench_clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double>(bench_clock::now() - start).count());
+    }
+    return best;
+}
+
+// 仿射变换 x -> a * x + b 的复合（模一个素数）：满足结合律，不满足交换律
+struct affine{
+    long long a, b;
+};
+long long const affine_mod = 1000000007;
+affine compose(affine const &f, affine const &g){     // 先 f 后 g
+    return {g.a * f.a % affine_mod, (g.a * f.b + g.b) % affine_mod};
+}
+bool operator==(affine const &f, affine const &g){
+    return f.a == g.a && f.b == g.b;
+}
+
+int main(){
+    bool ok = true;
+
+    // 1. 正确性
+    {
+        thread_pool tp(4);
+        std::mt19937 engine(3);
+        std::uniform_int_distribution<int> dist(-1000, 1000);
+        auto const max_op = [](int a, int b){ return std::max(a, b); };
+        for(std::size_t n: {std::size_t(0), std::size_t(1), std::size_t(3), std::size_t(17), std::size_t(40000),
+                            std::size_t(100003), std::size_t(1234567)}){
+            std::vector<int> v(n), expected(n), got(n);
+            for(auto &x: v){
+                x = dist(engine);
+            }
+            std::inclusive_scan(v.begin(), v.end(), expected.begin());
+            parallel_inclusive_scan(tp, v.begin(), v.end(), got.begin());
+            ok = ok && got == expected;
+
+            std::inclusive_scan(v.begin(), v.end(), expected.begin(), std::plus<>(), 11);
+            parallel_inclusive_scan(tp, v.begin(), v.end(), got.begin(), std::plus<>(), 11);
+            ok = ok && got == expected;
+
+            std::exclusive_scan(v.begin(), v.end(), expected.begin(), -7);
+            parallel_exclusive_scan(tp, v.begin(), v.end(), got.begin(), -7);
+            ok = ok && got == expected;
+
+            std::inclusive_scan(v.begin(), v.end(), expected.begin(), max_op);
+            parallel_inclusive_scan(tp, v.begin(), v.end(), got.begin(), max_op);
+            ok = ok && got == expected;
+
+            std::vector<long long> expected_ll(n), got_ll(n);
+            std::exclusive_scan(v.begin(), v.end(), expected_ll.begin(), 1LL << 40);
+            parallel_exclusive_scan(tp, v.begin(), v.end(), got_ll.begin(), 1LL << 40);
+            ok = ok && got_ll == expected_ll;
+
+            std::deque<int> d(v.begin(), v.end());
+            std::inclusive_scan(v.begin(), v.end(), expected.begin());
+            parallel_partial_sum(tp, d.begin(), d.end());
+            ok = ok && std::equal(d.begin(), d.end(), expected.begin());
+
+            got = v;
+            parallel_partial_sum(tp, got.begin(), got.end());
+            ok = ok && got == expected;
+
+            // long double 占 16 字节，不走 SIMD 路径；整数值的和是精确的
+            std::vector<long double> ld(v.begin(), v.end()), expected_ld(n);
+            std::inclusive_scan(ld.begin(), ld.end(), expected_ld.begin());
+            parallel_partial_sum(tp, ld.begin(), ld.end());
+            ok = ok && ld == expected_ld;
+        }
+        std::vector<affine> fs(300000);
+        for(auto &f: fs){
+            f = {dist(engine) + 1001, dist(engine) + 1000};
+        }
+        std::vector<affine> expected_f(fs.size()), got_f(fs.size());
+        std::inclusive_scan(fs.begin(), fs.end(), expected_f.begin(), compose);
+        parallel_inclusive_scan(tp, fs.begin(), fs.end(), got_f.begin(), compose);
+        ok = ok && got_f == expected_f;
+        std::exclusive_scan(fs.begin(), fs.end(), expected_f.begin(), affine{1, 0}, compose);
+        parallel_exclusive_scan(tp, fs.begin(), fs.end(), got_f.begin(), affine{1, 0}, compose);
+        ok = ok && got_f == expected_f;
+
+        std::vector<std::string> words(100000);
+        for(std::size_t i = 0; i < words.size(); ++i){
+            words[i] = std::string(1, char('a' + i % 26));
+        }
+        std::vector<std::string> expected_s(words.size()), got_s(words.size());
+        std::vector<std::string> tail(words.end() - 300, words.end());
+        std::exclusive_scan(tail.begin(), tail.end(), expected_s.begin(), std::string(">"));
+        parallel_exclusive_scan(tp, tail.begin(), tail.end(), got_s.begin(), std::string(">"));
+        ok = ok && std::equal(expected_s.begin(), expected_s.begin() + 300, got_s.begin());
+        bool caught = false;
+        try{
+            std::vector<int> v(1000000, 1), out(v.size());
+            parallel_inclusive_scan(tp, v.begin(), v.end(), out.begin(), [](int a, int b){
+                if(a == 900000){
+                    throw std::runtime_error("boom");
+                }
+                return a + b;
+            });
+        }catch (const std::runtime_error &){
+            caught = true;
+        }
+        ok = ok && caught;
+        std::cout << "correctness" << (ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+
+    // 2. 一亿个 int 原地求前缀和
+    {
+        thread_pool tp;
+        std::size_t const n = 100000000;
+        std::vector<int> data(n);
+        auto const reset = [&]{
+            for(std::size_t i = 0; i < n; ++i){
+                data[i] = int(i % 3);
+            }
+        };
+        double t_seq = 1e9, t_chain = 1e9, t_pool = 1e9;
+        std::vector<int> expected;
+        for(int r = 0; r < 3; ++r){
+            reset();
+            t_seq = std::min(t_seq, best_seconds([&]{ std::inclusive_scan(data.begin(), data.end(), data.begin()); }, 1));
+            expected = data;
+            reset();
+            t_chain = std::min(t_chain, best_seconds([&]{ future_chain_partial_sum(data.begin(), data.end()); }, 1));
+            ok = ok && data == expected;
+            reset();
+            t_pool = std::min(t_pool, best_seconds([&]{ parallel_partial_sum(tp, data.begin(), data.end()); }, 1));
+            ok = ok && data == expected;
+        }
+        std::cout << "in-place prefix sum of " << n << " ints, " << tp.thread_count() << " workers:" << std::endl;
+        std::cout << "  std::inclusive_scan    " << t_seq * 1000 << " ms" << std::endl;
+        std::cout << "  future chain (8.11)    " << t_chain * 1000 << " ms" << std::endl;
+        std::cout << "  parallel_partial_sum   " << t_pool * 1000 << " ms" << (ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+    return ok ? 0 : 1;
+}
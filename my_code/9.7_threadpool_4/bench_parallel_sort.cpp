@@ -0,0 +1,128 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 并行排序基准测试（std::execution::par 在 libstdc++ 中依赖 TBB，编译时需要 -ltbb）：
+// 1. 正确性：各种规模与分布下与 std::sort 的结果比较（4 个工作线程，覆盖并行划分），比较函数抛出的异常
+// 2. 两千万条 16 字节记录：std::sort、std::sort(std::execution::par)、parallel_sort，
+//    输入分布为随机、有序、逆序、只有 16 种键、先增后减（organ pipe）
+
+#include "parallel_sort.h"
+#include <chrono>
+#include <cstdint>
+#include <execution>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+struct record{
+    std::uint64_t key;
+    std::uint64_t payload;
+};
+
+bool by_key(const record &a, const record &b){
+    return a.key < b.key;
+}
+
+std::vector<record> make_records(std::size_t n, int distribution, std::uint64_t seed){
+    std::mt19937_64 engine(seed);
+    std::vector<record> v(n);
+    for(std::size_t i = 0; i < n; ++i){
+        std::uint64_t key = 0;
+        switch(distribution){
+            case 0: key = engine(); break;
+            case 1: key = i; break;
+            case 2: key = n - i; break;
+            case 3: key = engine() % 16; break;
+            default: key = i < n / 2 ? i : n - i; break;
+        }
+        v[i] = {key, engine()};
+    }
+    return v;
+}
+
+// 键序列相同且载荷的多重集合相同（不稳定排序不保证相等键的相对顺序）
+bool same_result(const std::vector<record> &got, const std::vector<record> &expected){
+    std::uint64_t sum_got = 0, sum_expected = 0, xor_got = 0, xor_expected = 0;
+    for(std::size_t i = 0; i < got.size(); ++i){
+        if(got[i].key != expected[i].key){
+            return false;
+        }
+        sum_got += got[i].payload;
+        xor_got ^= got[i].payload * 0x9e3779b97f4a7c15ULL;
+        sum_expected += expected[i].payload;
+        xor_expected ^= expected[i].payload * 0x9e3779b97f4a7c15ULL;
+    }
+    return sum_got == sum_expected && xor_got == xor_expected;
+}
+
+const char *const distribution_names[] = {"random", "sorted", "reversed", "16 keys", "organ pipe"};
+
+int main(){
+    bool ok = true;
+
+    // 1. 正确性
+    {
+        thread_pool tp(4);
+        for(std::size_t n: {std::size_t(0), std::size_t(1), std::size_t(1000), std::size_t(20000), std::size_t(300000),
+                            std::size_t(3000000)}){
+            for(int d = 0; d < 5; ++d){
+                std::vector<record> v = make_records(n, d, n + d), expected = v;
+                std::sort(expected.begin(), expected.end(), by_key);
+                parallel_sort(tp, v.begin(), v.end(), by_key);
+                ok = ok && same_result(v, expected);
+            }
+        }
+        std::vector<int> ints(2000000);
+        std::mt19937 engine(5);
+        for(auto &x: ints){
+            x = int(engine() % 1000);
+        }
+        parallel_sort(tp, ints.begin(), ints.end(), std::greater<>());
+        ok = ok && std::is_sorted(ints.begin(), ints.end(), std::greater<>());
+
+        bool caught = false;
+        try{
+            std::atomic<int> calls(0);
+            std::vector<record> v = make_records(1000000, 0, 9);
+            parallel_sort(tp, v.begin(), v.end(), [&calls](const record &a, const record &b){
+                if(calls.fetch_add(1, std::memory_order_relaxed) == 5000000){
+                    throw std::runtime_error("boom");
+                }
+                return a.key < b.key;
+            });
+        }catch (const std::runtime_error &){
+            caught = true;
+        }
+        ok = ok && caught;
+        std::cout << "correctness" << (ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+
+    // 2. 两千万条记录
+    {
+        thread_pool tp;
+        std::size_t const n = 20000000;
+        std::cout << "sorting " << n << " records of 16 bytes, " << tp.thread_count() << " workers (ms):" << std::endl;
+        std::cout << "  distribution    std::sort    par    parallel_sort" << std::endl;
+        for(int d = 0; d < 5; ++d){
+            std::vector<record> const input = make_records(n, d, 42);
+            std::vector<record> expected = input, v = input;
+            auto const t0 = bench_clock::now();
+            std::sort(expected.begin(), expected.end(), by_key);
+            auto const t1 = bench_clock::now();
+            std::sort(std::execution::par, v.begin(), v.end(), by_key);
+            auto const t2 = bench_clock::now();
+            v = input;
+            auto const t3 = bench_clock::now();
+            parallel_sort(tp, v.begin(), v.end(), by_key);
+            auto const t4 = bench_clock::now();
+            bool const sorted_ok = same_result(v, expected);
+            ok = ok && sorted_ok;
+            auto const ms = [](auto d){ return std::chrono::duration_cast<std::chrono::milliseconds>(d).count(); };
+            std::cout << "  " << distribution_names[d] << "\t" << ms(t1 - t0) << "\t" << ms(t2 - t1) << "\t" << ms(t4 - t3)
+                      << (sorted_ok ? "  check." : "  MISMATCH") << std::endl;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 优先级车道基准测试：后台持续提交大量低优先级任务（每个约 20us），让线程池始终处于饱和状态，
+// 同时每隔 500us 提交一个探测任务，记录它从提交到开始执行的延迟。
+// 探测任务与后台任务同为低优先级时，要排在整个积压队列之后；提交为高优先级时，只需等待正在执行的任务结束
+
+#include "threadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+void spin_for(std::chrono::microseconds d){
+    auto const end = bench_clock::now() + d;
+    while(bench_clock::now() < end){
+    }
+}
+
+// 返回探测任务延迟的 (p50, p99, max)，单位 us
+std::vector<long long> probe_latency(thread_pool &tp, task_priority probe_priority, int probe_count, int backlog){
+    std::atomic<int> outstanding(0);
+    std::atomic<int> probes_done(0);
+    std::vector<long long> latencies(probe_count);
+    for(int i = 0; i < probe_count; ++i){
+        while(outstanding.load(std::memory_order_relaxed) < backlog){
+            outstanding.fetch_add(1, std::memory_order_relaxed);
+            tp.post(task_priority::low, [&outstanding]{
+                spin_for(std::chrono::microseconds(20));
+                outstanding.fetch_sub(1, std::memory_order_relaxed);
+            });
+        }
+        auto const submitted = bench_clock::now();
+        tp.post(probe_priority, [&latencies, &probes_done, submitted, i]{
+            latencies[i] = std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - submitted).count();
+            probes_done.fetch_add(1, std::memory_order_release);
+        });
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    while(probes_done.load(std::memory_order_acquire) < probe_count || outstanding.load(std::memory_order_relaxed) > 0){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return {latencies[probe_count / 2], latencies[probe_count * 99 / 100], latencies.back()};
+}
+
+int main(){
+    thread_pool tp;
+    int const probe_count = 2000, backlog = 200 * static_cast<int>(tp.thread_count());
+    for(auto [priority, name]: {std::pair{task_priority::low, "low  "}, std::pair{task_priority::high, "high "}}){
+        std::vector<long long> const r = probe_latency(tp, priority, probe_count, backlog);
+        std::cout << name << "priority probes under saturating low-priority load: p50 " << r[0] << " us, p99 " << r[1]
+                  << " us, max " << r[2] << " us" << std::endl;
+    }
+
+    // 防饥饿：始终有若干个高优先级任务在排队（每个执行时再提交一个自己）时，低优先级任务仍能执行完
+    std::atomic<bool> stop(false);
+    std::atomic<int> flooding(0), low_done(0);
+    std::function<void()> flood = [&]{
+        if(stop.load(std::memory_order_relaxed)){
+            flooding.fetch_sub(1, std::memory_order_release);
+        }else{
+            tp.post(task_priority::high, flood);
+        }
+    };
+    for(int i = 0; i < 4; ++i){
+        flooding.fetch_add(1, std::memory_order_relaxed);
+        tp.post(task_priority::high, flood);
+    }
+    for(int i = 0; i < 100; ++i){
+        tp.post(task_priority::low, [&low_done]{ low_done.fetch_add(1, std::memory_order_relaxed); });
+    }
+    auto const start = bench_clock::now();
+    while(low_done.load(std::memory_order_relaxed) < 100 && bench_clock::now() - start < std::chrono::seconds(10)){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // 只有在 10s 的窗口内、洪泛仍在进行时执行完的低优先级任务才算数，停止洪泛之后才完成的说明发生了饥饿
+    int const done_in_window = low_done.load(std::memory_order_relaxed);
+    auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - start).count();
+    stop = true;
+    while(flooding.load(std::memory_order_acquire) > 0 || low_done.load(std::memory_order_relaxed) < 100){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if(done_in_window < 100){
+        std::cout << "low-priority tasks starved under a high-priority flood: " << done_in_window << " / 100 after "
+                  << elapsed << " ms  MISMATCH" << std::endl;
+        return 1;
+    }
+    std::cout << "low-priority tasks finished under a high-priority flood in " << elapsed << " ms  check." << std::endl;
+    return 0;
+}
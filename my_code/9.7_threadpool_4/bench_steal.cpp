@@ -0,0 +1,50 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 窃取策略基准测试：一个工作线程（队列的持有者）不断向本地队列提交并执行极小的任务，
+// 其余工作线程基本空闲、只能靠窃取获得任务。工作线程数从 1 增加到 64 时，
+// 持有者的吞吐量不应明显下降；同时打印窃取尝试/成功次数
+
+#include "threadpool.h"
+#include <chrono>
+#include <iostream>
+
+// 在某个工作线程上运行：提交 task_count 个任务到本地队列，并与窃取者一起把它们执行完
+double owner_throughput(thread_pool &tp, int task_count){
+    std::atomic<int> finished(0);
+    auto owner = tp.submit([&]{
+        auto const start = std::chrono::steady_clock::now();
+        for(int i = 0; i < task_count; ++i){
+            tp.post([&finished]{ finished.fetch_add(1, std::memory_order_relaxed); });
+            if(i % 4 == 3){     // 持有者每提交4个任务执行一个，队列中始终留有可窃取的任务
+                tp.try_run_pending_task();
+            }
+        }
+        while(finished.load(std::memory_order_relaxed) < task_count){
+            if(!tp.try_run_pending_task()){
+                thread_pool::cpu_relax();
+            }
+        }
+        auto const us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        return us ? double(task_count) / us : 0.0;
+    });
+    return owner.get();
+}
+
+int main(){
+    int const task_count = 1000000;
+    for(std::size_t workers: {1, 4, 16, 64}){
+        thread_pool tp(workers);
+        owner_throughput(tp, task_count / 10);  // 预热
+        thread_pool_stats const before = tp.stats();
+        double const throughput = owner_throughput(tp, task_count);
+        thread_pool_stats const after = tp.stats();
+        std::uint64_t const attempts = after.steal_attempts - before.steal_attempts;
+        std::uint64_t const successes = after.steal_successes - before.steal_successes;
+        std::cout << workers << " workers: " << throughput << " M tasks/s"
+                  << ", steal attempts " << attempts << ", successes " << successes
+                  << ", tasks stolen " << after.tasks_stolen - before.tasks_stolen
+                  << ", success rate " << (attempts ? 100.0 * successes / attempts : 0.0) << "%  check." << std::endl;
+    }
+    return 0;
+}
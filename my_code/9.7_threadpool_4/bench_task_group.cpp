@@ -0,0 +1,107 @@
+//
+// Created by chen on 2026/10/18.
+//
+// task_group 示例与基准测试：递归分治（斐波那契、快速排序）只使用线程池中的固定线程，
+// 对比串行版本，并检查结果正确；另一个线程池的工作线程等待本池的任务组时应当睡眠，而不是空转
+
+#include "task_group.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+long fib_serial(int n){
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+long fib_parallel(thread_pool &tp, int n){
+    if(n < 20){     // 足够小时串行计算，避免任务粒度过细
+        return fib_serial(n);
+    }
+    long x = 0, y = 0;
+    task_group g(tp);
+    g.spawn([&]{ x = fib_parallel(tp, n - 1); });
+    y = fib_parallel(tp, n - 2);
+    g.wait();
+    return x + y;
+}
+
+template<class Iterator>
+void quick_sort_parallel(thread_pool &tp, Iterator first, Iterator last){
+    if(last - first < 10000){
+        std::sort(first, last);
+        return;
+    }
+    auto const pivot = *(first + (last - first) / 2);
+    Iterator middle1 = std::partition(first, last, [&](auto const &x){ return x < pivot; });
+    Iterator middle2 = std::partition(middle1, last, [&](auto const &x){ return !(pivot < x); });
+    task_group g(tp);
+    g.spawn([&tp, first, middle1]{ quick_sort_parallel(tp, first, middle1); });
+    quick_sort_parallel(tp, middle2, last);
+    g.wait();
+}
+
+template<class Function>
+long long time_ms(Function f){
+    auto const start = bench_clock::now();
+    f();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - start).count();
+}
+
+// 线程池 b 的工作线程正在执行一个睡眠 300ms 的子任务时，线程池 a 的工作线程等待这个任务组。
+// 等待者没有 b 的任务可帮忙执行，应当睡眠在 b 的 completion_event 上，而不是让出时间片空转
+void cross_pool_wait(){
+    thread_pool a(1), b(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));    // 等两个池的工作线程进入睡眠
+    std::atomic<bool> started(false);
+    task_group g(b);
+    g.spawn([&started]{
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    });
+    while(!started){
+        std::this_thread::yield();
+    }
+    std::clock_t const cpu_start = std::clock();
+    a.submit([&g]{ g.wait(); }).get();
+    double const cpu_ms = 1000.0 * double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    std::cout << "worker of another pool waiting ~300 ms on a task_group: " << cpu_ms << " ms CPU"
+              << (cpu_ms < 50 ? "  check." : "  MISMATCH") << std::endl;
+}
+
+int main(){
+    cross_pool_wait();
+    thread_pool tp;
+
+    long r1 = 0, r2 = 0;
+    auto const t1 = time_ms([&]{ r1 = fib_serial(36); });
+    auto const t2 = time_ms([&]{ r2 = fib_parallel(tp, 36); });
+    std::cout << "fib(36): serial " << t1 << " ms, task_group " << t2 << " ms"
+              << (r1 == r2 ? "  check." : "  MISMATCH") << std::endl;
+
+    std::vector<int> v(10000000);
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> dist(0, 1000000);
+    for(auto &x: v){
+        x = dist(engine);
+    }
+    std::vector<int> v2(v);
+    auto const t3 = time_ms([&]{ std::sort(v.begin(), v.end()); });
+    auto const t4 = time_ms([&]{ quick_sort_parallel(tp, v2.begin(), v2.end()); });
+    std::cout << "sort 1e7 ints: std::sort " << t3 << " ms, task_group quick sort " << t4 << " ms"
+              << (v == v2 ? "  check." : "  MISMATCH") << std::endl;
+
+    // 子任务中的异常会在 wait() 中重新抛出
+    try{
+        task_group g(tp);
+        g.spawn([]{ throw std::runtime_error("error in child task"); });
+        g.wait();
+    }catch (std::exception &e){
+        std::cout << "caught: " << e.what() << std::endl;
+    }
+    return 0;
+}
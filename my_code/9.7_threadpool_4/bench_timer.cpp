@@ -0,0 +1,117 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 时间轮示例与基准测试：
+// 1. submit_after 的延迟是否准确（不会提前，推迟不超过几个 tick），取消的任务不会执行
+// 2. submit_every 周期任务的执行次数，取消之后不再执行
+// 3. 一百万个待触发定时器的插入与取消耗时；十万个定时器在半秒内全部触发
+
+#include "threadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+int main(){
+    thread_pool tp;
+    bool ok = true;
+
+    // 1. 延迟的准确性
+    {
+        int const delays_ms[] = {0, 1, 5, 20, 50, 100, 300};
+        int const n = sizeof(delays_ms) / sizeof(delays_ms[0]);
+        std::vector<long long> lateness(n, -1);
+        std::atomic<int> fired(0), cancelled_fired(0);
+        auto const start = bench_clock::now();
+        for(int i = 0; i < n; ++i){
+            auto const deadline = start + std::chrono::milliseconds(delays_ms[i]);
+            tp.submit_at(deadline, [&, i, deadline]{
+                lateness[i] = std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - deadline).count();
+                fired.fetch_add(1);
+            });
+        }
+        timer_id const id = tp.submit_after(std::chrono::milliseconds(30), [&]{ cancelled_fired.fetch_add(1); });
+        ok = ok && tp.cancel_timer(id) && !tp.cancel_timer(id);
+        while(fired.load() < n){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::cout << "lateness (us):";
+        for(int i = 0; i < n; ++i){
+            std::cout << " " << delays_ms[i] << "ms->" << lateness[i];
+            ok = ok && lateness[i] >= 0;
+        }
+        ok = ok && cancelled_fired.load() == 0;
+        std::cout << (ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+
+    // 2. 周期任务
+    {
+        std::atomic<int> runs(0);
+        timer_id const id = tp.submit_every(std::chrono::milliseconds(10), [&]{ runs.fetch_add(1); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(205));
+        ok = ok && tp.cancel_timer(id);
+        int const at_cancel = runs.load();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        bool const periodic_ok = at_cancel >= 15 && at_cancel <= 21 && runs.load() <= at_cancel + 1;
+        ok = ok && periodic_ok;
+        std::cout << "every 10ms for 205ms: " << at_cancel << " runs, " << runs.load() << " after cancel"
+                  << (periodic_ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+
+    // 3. 一百万个定时器的插入与取消
+    {
+        int const count = 1000000;
+        std::mt19937 engine(42);
+        std::uniform_int_distribution<int> delay_ms(60 * 1000, 3600 * 1000);
+        std::vector<timer_id> ids(count);
+        std::atomic<int> fired(0);
+        auto const t0 = bench_clock::now();
+        for(int i = 0; i < count; ++i){
+            ids[i] = tp.submit_after(std::chrono::milliseconds(delay_ms(engine)), [&fired]{ fired.fetch_add(1); });
+        }
+        auto const t1 = bench_clock::now();
+        std::size_t const pending = tp.pending_timers();
+        std::shuffle(ids.begin(), ids.end(), engine);
+        int cancelled = 0;
+        for(timer_id id: ids){
+            cancelled += tp.cancel_timer(id);
+        }
+        auto const t2 = bench_clock::now();
+        bool const bulk_ok = pending == std::size_t(count) && cancelled == count && tp.pending_timers() == 0 && fired.load() == 0;
+        ok = ok && bulk_ok;
+        std::cout << count << " timers: insert " << std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / count
+                  << " ns, cancel " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / count
+                  << " ns per timer" << (bulk_ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+
+    // 十万个定时器在 500ms 内陆续触发
+    {
+        int const count = 100000;
+        std::mt19937 engine(7);
+        std::uniform_int_distribution<int> delay_us(0, 500000);
+        std::atomic<int> fired(0), early(0);
+        for(int i = 0; i < count; ++i){
+            auto const deadline = bench_clock::now() + std::chrono::microseconds(delay_us(engine));
+            tp.submit_at(deadline, [&, deadline]{
+                if(bench_clock::now() < deadline){
+                    early.fetch_add(1);
+                }
+                fired.fetch_add(1);
+            });
+        }
+        auto const start = bench_clock::now();
+        while(fired.load() < count && bench_clock::now() - start < std::chrono::seconds(5)){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        bool const fire_ok = fired.load() == count && early.load() == 0;
+        ok = ok && fire_ok;
+        std::cout << count << " timers fired within "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - start).count() << " ms, "
+                  << early.load() << " early" << (fire_ok ? "  check." : "  MISMATCH") << std::endl;
+    }
+    return ok ? 0 : 1;
+}
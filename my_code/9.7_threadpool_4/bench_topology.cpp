@@ -0,0 +1,145 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 拓扑感知的 thread_pool：打印检测到的 CPU 拓扑与每个工作线程的窃取顺序，
+// 并对比绑定/不绑定工作线程时 task_group 递归分治（斐波那契）的耗时；
+// 另外用一个临时目录模拟节点编号不连续、含有无 CPU 节点的 /sys/devices/system/node，检查 CPU 到节点的映射；
+// 以及一个线程池的工作线程向另一个（线程更少的）线程池提交任务时，任务进入目标线程池并在它的工作线程上执行；
+// 池外线程每次提交都要调用 current_node，检查它的查表结果与 cpus 一致并测量单次耗时
+
+#include "task_group.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+long fib_serial(int n){
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+long fib_parallel(thread_pool &tp, int n){
+    if(n < 20){
+        return fib_serial(n);
+    }
+    long x = 0, y = 0;
+    task_group g(tp);
+    g.spawn([&]{ x = fib_parallel(tp, n - 1); });
+    y = fib_parallel(tp, n - 2);
+    g.wait();
+    return x + y;
+}
+
+void print_topology(const thread_pool &tp){
+    const cpu_topology &topology = tp.topology_info();
+    std::cout << topology.cpus.size() << " cpus, " << topology.node_count << " numa node(s)" << std::endl;
+    for(unsigned i = 0; i < tp.thread_count(); ++i){
+        const cpu_info &cpu = tp.worker_cpu(i);
+        std::cout << "worker " << i << ": cpu " << cpu.cpu << " node " << cpu.node << " package " << cpu.package
+                  << ", steal order:";
+        for(unsigned victim: tp.worker_steal_order(i)){
+            std::cout << " " << victim;
+        }
+        std::cout << std::endl;
+    }
+}
+
+// 节点 0、2 有 CPU，节点 1 只有内存（cpulist 为空），节点 3 不在 online 中
+bool check_sparse_nodes(){
+    namespace fs = std::filesystem;
+    fs::path const dir = fs::temp_directory_path() / ("cpu_topology_nodes_" + std::to_string(std::rand()));
+    auto write = [&](const std::string &file, const std::string &content){
+        fs::create_directories((dir / file).parent_path());
+        std::ofstream(dir / file) << content << "\n";
+    };
+    write("online", "0-2");
+    write("node0/cpulist", "0-1");
+    write("node1/cpulist", "");
+    write("node2/cpulist", "2-3,6");
+    write("node3/cpulist", "4-5");
+    std::vector<unsigned> const node_of = cpu_topology::read_node_map(dir.string());
+    fs::remove_all(dir);
+    std::vector<unsigned> const expected{0, 0, 2, 2, 0, 0, 2};
+    std::cout << "sparse node ids, cpu -> node:";
+    for(unsigned node: node_of){
+        std::cout << " " << node;
+    }
+    bool const ok = node_of == expected;
+    std::cout << (ok ? "  check." : "  MISMATCH") << std::endl;
+    return ok;
+}
+
+bool check_current_node(const cpu_topology &topology){
+    bool ok = true;
+    for(auto &c: topology.cpus){
+        ok = ok && c.cpu < topology.node_by_cpu.size() && topology.node_by_cpu[c.cpu] == c.node;
+    }
+    int const n = 1000000;
+    unsigned sum = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for(int i = 0; i < n; ++i){
+        unsigned const node = topology.current_node();
+        ok = ok && node < topology.node_count;
+        sum += node;
+    }
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "current_node: " << double(ns) / n << " ns/call (node sum " << sum << ")"
+              << (ok ? "  check." : "  MISMATCH") << std::endl;
+    return ok;
+}
+
+bool check_cross_pool_submit(){
+    thread_pool a(4), b(1);
+    std::thread::id const b_worker = b.submit([]{ return std::this_thread::get_id(); }).get();
+    std::mutex m;
+    std::set<std::thread::id> ran_on;
+    std::vector<std::future<void>> outer;
+    for(int i = 0; i < 16; ++i){
+        outer.push_back(a.submit([&]{
+            std::vector<std::future<void>> inner;
+            for(int j = 0; j < 16; ++j){
+                inner.push_back(b.submit([&]{
+                    std::lock_guard<std::mutex> lk(m);
+                    ran_on.insert(std::this_thread::get_id());
+                }));
+            }
+            for(auto &f: inner){
+                f.get();
+            }
+        }));
+    }
+    for(auto &f: outer){
+        f.get();
+    }
+    bool const ok = ran_on.size() == 1 && *ran_on.begin() == b_worker;
+    std::cout << "cross-pool submit from 4 workers into a 1-worker pool: ran on " << ran_on.size() << " thread(s)"
+              << (ok ? "  check." : "  MISMATCH") << std::endl;
+    return ok;
+}
+
+int main(){
+    check_sparse_nodes();
+    check_current_node(cpu_topology::detect());
+    check_cross_pool_submit();
+    long const expected = fib_serial(34);
+    for(bool pin: {false, true}){
+        thread_pool tp(0, pin);
+        if(!pin){
+            print_topology(tp);
+        }
+        auto const start = std::chrono::steady_clock::now();
+        long const r = fib_parallel(tp, 34);
+        auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << (pin ? "pinned   " : "unpinned ") << "fib(34): " << ms << " ms"
+                  << (r == expected ? "  check." : "  MISMATCH") << std::endl;
+    }
+
+    // 工作线程数多于 CPU 时按 CPU 轮流分配，窃取顺序仍覆盖所有线程
+    thread_pool tp(8);
+    print_topology(tp);
+    std::cout << "fib(30) with 8 workers: " << fib_parallel(tp, 30) << (fib_parallel(tp, 30) == fib_serial(30) ? "  check." : "  MISMATCH")
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,169 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// CPU 拓扑：从 /sys/devices/system/cpu 与 /sys/devices/system/node 读取每个逻辑 CPU 所在的物理核、插槽与 NUMA 节点，
+// 供线程池按拓扑绑定工作线程、划分每个节点的任务队列以及安排窃取顺序
+// - 只包含当前进程允许运行的 CPU（sched_getaffinity），在容器或 taskset 下也能得到正确的集合
+// - 读不到 /sys（非 Linux 或被屏蔽）时退化为 hardware_concurrency 个 CPU，全部位于节点0、各自一个物理核
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_CPU_TOPOLOGY_H
+#define CPP_CONCURRENCY_IN_ACTION_CPU_TOPOLOGY_H
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct cpu_info{
+    unsigned cpu;       // 逻辑 CPU 编号
+    unsigned core;      // 物理核（同一插槽内的 core_id 与插槽号组合，全局唯一）
+    unsigned package;   // 插槽
+    unsigned node;      // NUMA 节点
+};
+
+class cpu_topology{
+public:
+    // 按 (节点, 插槽, 物理核, 逻辑CPU) 排序，同一物理核上的超线程相邻，同一节点的 CPU 连续
+    std::vector<cpu_info> cpus;
+    unsigned node_count = 1;
+    // 按逻辑 CPU 编号下标的（压缩后的）节点号，供 current_node 直接查表；不属于 cpus 的 CPU 为节点0
+    std::vector<unsigned> node_by_cpu;
+
+    static cpu_topology detect(){
+        cpu_topology res;
+        std::vector<unsigned> online = parse_cpu_list(read_line("/sys/devices/system/cpu/online"));
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0){
+            online.erase(std::remove_if(online.begin(), online.end(), [&](unsigned cpu){
+                return cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed);
+            }), online.end());
+        }
+#endif
+        std::vector<unsigned> const node_of = read_node_map();
+        for(unsigned cpu: online){
+            std::string const base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            unsigned const package = read_number(base + "physical_package_id", 0);
+            unsigned const core_id = read_number(base + "core_id", cpu);
+            unsigned const node = cpu < node_of.size() ? node_of[cpu] : 0;
+            res.cpus.push_back(cpu_info{cpu, package * 65536 + core_id, package, node});
+        }
+        if(res.cpus.empty()){
+            unsigned const n = std::max(1u, std::thread::hardware_concurrency());
+            for(unsigned cpu = 0; cpu < n; ++cpu){
+                res.cpus.push_back(cpu_info{cpu, cpu, 0, 0});
+            }
+        }
+        std::sort(res.cpus.begin(), res.cpus.end(), [](const cpu_info &a, const cpu_info &b){
+            return std::tie(a.node, a.package, a.core, a.cpu) < std::tie(b.node, b.package, b.core, b.cpu);
+        });
+        // 节点编号压缩为 0 ~ node_count-1（只统计实际用到的节点）
+        std::vector<unsigned> nodes;
+        for(auto &c: res.cpus){
+            if(nodes.empty() || nodes.back() != c.node){
+                nodes.push_back(c.node);
+            }
+        }
+        for(auto &c: res.cpus){
+            c.node = static_cast<unsigned>(std::find(nodes.begin(), nodes.end(), c.node) - nodes.begin());
+        }
+        res.node_count = static_cast<unsigned>(nodes.size());
+        for(auto &c: res.cpus){
+            if(c.cpu >= res.node_by_cpu.size()){
+                res.node_by_cpu.resize(c.cpu + 1, 0);
+            }
+            res.node_by_cpu[c.cpu] = c.node;
+        }
+        return res;
+    }
+
+    // 每个逻辑 CPU 所在的 NUMA 节点（按 CPU 编号下标，未列出的 CPU 为节点0）。
+    // 节点编号可能不连续，也可能有不含 CPU 的节点（例如只有内存的 CXL 节点），
+    // 因此按 online 列出的节点逐个读取 cpulist，而不是从 node0 开始数到第一个缺失的节点
+    static std::vector<unsigned> read_node_map(const std::string &node_dir = "/sys/devices/system/node"){
+        std::vector<unsigned> node_of;
+        for(unsigned node: parse_cpu_list(read_line(node_dir + "/online"))){
+            for(unsigned cpu: parse_cpu_list(read_line(node_dir + "/node" + std::to_string(node) + "/cpulist"))){
+                if(cpu >= node_of.size()){
+                    node_of.resize(cpu + 1, 0);
+                }
+                node_of[cpu] = node;
+            }
+        }
+        return node_of;
+    }
+
+    // 当前线程正在运行的 CPU 所在的节点；无法得知时返回 0。池外线程每次提交任务都会调用，因此只查表，不遍历 cpus
+    unsigned current_node() const{
+#if defined(__linux__)
+        int const cpu = sched_getcpu();
+        if(cpu >= 0 && static_cast<std::size_t>(cpu) < node_by_cpu.size()){
+            return node_by_cpu[cpu];
+        }
+#endif
+        return 0;
+    }
+
+    // 把当前线程绑定到指定的逻辑 CPU，失败时（例如没有权限）保持不变
+    static bool pin_current_thread(unsigned cpu){
+#if defined(__linux__)
+        if(cpu >= CPU_SETSIZE){
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+private:
+    static std::string read_line(const std::string &path){
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    static unsigned read_number(const std::string &path, unsigned default_value){
+        std::string const line = read_line(path);
+        try{
+            return line.empty() ? default_value : static_cast<unsigned>(std::stoul(line));
+        }catch (...){
+            return default_value;
+        }
+    }
+
+    // 解析 "0-3,8,10-11" 这样的 CPU 列表（节点列表的格式相同）
+    static std::vector<unsigned> parse_cpu_list(const std::string &list){
+        std::vector<unsigned> res;
+        std::stringstream ss(list);
+        std::string range;
+        while(std::getline(ss, range, ',')){
+            try{
+                std::size_t const dash = range.find('-');
+                unsigned const first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+                unsigned const last = dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+                for(unsigned cpu = first; cpu <= last; ++cpu){
+                    res.push_back(cpu);
+                }
+            }catch (...){
+            }
+        }
+        return res;
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_CPU_TOPOLOGY_H
@@ -0,0 +1,82 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 事件计数器（eventcount）：让空闲线程在没有任务时真正睡眠，而不是一直自旋
+// 使用方式（等待方）：
+//     auto key = ec.prepare_wait();
+//     if(条件已满足){ ec.cancel_wait(); }
+//     else{ ec.commit_wait(key); }
+// 通知方在让条件满足之后调用 notify_one() / notify_all()
+// 没有线程在等待时，notify 只有一次原子读，不会进入内核
+// 睡眠基于 C++20 的 std::atomic::wait，在 Linux 上由 futex 实现
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_EVENT_COUNT_H
+#define CPP_CONCURRENCY_IN_ACTION_EVENT_COUNT_H
+
+#include <atomic>
+#include <cstdint>
+
+class event_count{
+public:
+    event_count(): epoch(0), waiters(0){}
+    event_count(const event_count&) = delete;
+    event_count& operator=(const event_count&) = delete;
+
+    std::uint32_t prepare_wait(){
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);    // 之后对条件的检查不能被重排到登记之前
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    void cancel_wait(){
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 若 prepare_wait 之后已经有人通知过，epoch 已改变，wait 会立即返回
+    void commit_wait(std::uint32_t key){
+        epoch.wait(key, std::memory_order_acquire);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify_one(){
+        std::atomic_thread_fence(std::memory_order_seq_cst);    // 与 prepare_wait 中的栅栏配对，保证不丢失唤醒
+        if(waiters.load(std::memory_order_relaxed) != 0){
+            epoch.fetch_add(1, std::memory_order_release);
+            epoch.notify_one();
+        }
+    }
+
+    // 条件是由一个 seq_cst 的读-改-写操作（例如 CAS）改变的，并且该操作之后才调用本函数时使用：
+    // 那次读-改-写已经与 prepare_wait 中的栅栏排成全序，这里只需一次 seq_cst 的读（x86 上是普通的 mov），不再需要栅栏
+    void notify_one_after_rmw(){
+        if(waiters.load(std::memory_order_seq_cst) != 0){
+            epoch.fetch_add(1, std::memory_order_release);
+            epoch.notify_one();
+        }
+    }
+
+    // 唤醒至多 n 个等待者
+    void notify_n(unsigned n){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int const w = waiters.load(std::memory_order_relaxed);
+        for(unsigned i = 0; i < n && int(i) < w; ++i){
+            epoch.fetch_add(1, std::memory_order_release);
+            epoch.notify_one();
+        }
+    }
+
+    void notify_all(){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters.load(std::memory_order_relaxed) != 0){
+            epoch.fetch_add(1, std::memory_order_release);
+            epoch.notify_all();
+        }
+    }
+
+private:
+    std::atomic<std::uint32_t> epoch;
+    std::atomic<int> waiters;
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_EVENT_COUNT_H
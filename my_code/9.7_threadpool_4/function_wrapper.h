@@ -5,43 +5,111 @@
 #ifndef CPP_CONCURRENCY_IN_ACTION_FUNCTION_WRAPPER_H
 #define CPP_CONCURRENCY_IN_ACTION_FUNCTION_WRAPPER_H
 
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
-// 函数封装器
-class function_wrapper{
+// 函数封装器（只可移动）
+// 带有小缓冲区优化：大小不超过 InlineSize、对齐要求不超过 Align 的可调用对象直接构造在内部缓冲区中，不分配堆内存；
+// 更大的可调用对象才退回到 new 出来的堆对象。
+// 传入右值时移动可调用对象，传入左值时复制它（与 std::function 相同），不会从调用者的对象中偷偷移走内容
+template<std::size_t InlineSize, std::size_t Align = alignof(std::max_align_t)>
+class basic_function_wrapper{
 public:
-    template<class Function>
-    function_wrapper(Function &&f): impl(new impl_type<Function>(std::move(f))){}
-    function_wrapper() = default;
-    function_wrapper(function_wrapper &&other): impl(std::move(other.impl)){}
-    function_wrapper& operator=(function_wrapper &&other){
-        impl = std::move(other.impl);
+    template<class Function, class = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, basic_function_wrapper>>>
+    basic_function_wrapper(Function &&f){
+        using impl = impl_type<std::decay_t<Function>>;
+        if constexpr(fits_inline<impl>()){
+            ptr = ::new(static_cast<void*>(buffer)) impl(std::forward<Function>(f));
+        }else{
+            ptr = new impl(std::forward<Function>(f));
+        }
+    }
+    basic_function_wrapper() = default;
+    basic_function_wrapper(basic_function_wrapper &&other) noexcept{
+        take(other);
+    }
+    basic_function_wrapper& operator=(basic_function_wrapper &&other) noexcept{
+        if(this != &other){
+            reset();
+            take(other);
+        }
         return *this;
     }
-    function_wrapper(const function_wrapper&) = delete;
-    function_wrapper(function_wrapper&) = delete;
-    function_wrapper& operator=(const function_wrapper&) = delete;
+    basic_function_wrapper(const basic_function_wrapper&) = delete;
+    basic_function_wrapper(basic_function_wrapper&) = delete;
+    basic_function_wrapper& operator=(const basic_function_wrapper&) = delete;
+
+    ~basic_function_wrapper(){
+        reset();
+    }
 
     void operator()(){
-        impl->call();
+        ptr->call();
+    }
+
+    explicit operator bool() const{
+        return ptr != nullptr;
+    }
+
+    // 可调用对象是否存放在内部缓冲区中
+    bool is_inline() const{
+        return ptr != nullptr && static_cast<void const*>(ptr) == static_cast<void const*>(buffer);
     }
 
 private:
     struct impl_base{
         virtual void call() = 0;
+        virtual impl_base* move_to(void *storage) noexcept = 0;    // 移动构造到另一个缓冲区中
         virtual ~impl_base(){}
     };
 
-    std::unique_ptr<impl_base> impl;
-
     template<class Function>
     struct impl_type: impl_base{
         Function f;
-        explicit impl_type(Function &&f_): f(std::move(f_)){}
-        void call(){
+        template<class F>
+        explicit impl_type(F &&f_): f(std::forward<F>(f_)){}
+        void call() override{
             f();
         }
+        impl_base* move_to(void *storage) noexcept override{
+            return ::new(storage) impl_type(std::move(f));
+        }
     };
+
+    // 移动时需要在缓冲区之间搬运对象，因此只有不抛异常的移动构造才允许内联存放
+    template<class Impl>
+    static constexpr bool fits_inline(){
+        return sizeof(Impl) <= InlineSize && alignof(Impl) <= Align
+               && std::is_nothrow_move_constructible_v<Impl>;
+    }
+
+    alignas(Align) unsigned char buffer[InlineSize];
+    impl_base *ptr = nullptr;
+
+    void reset(){
+        if(is_inline()){
+            ptr->~impl_base();
+        }else{
+            delete ptr;
+        }
+        ptr = nullptr;
+    }
+
+    void take(basic_function_wrapper &other){
+        if(other.is_inline()){
+            ptr = other.ptr->move_to(buffer);
+            other.ptr->~impl_base();
+        }else{
+            ptr = other.ptr;
+        }
+        other.ptr = nullptr;
+    }
 };
 
+// 默认 64 字节的封装器：内联缓冲区 + 一个指针，足以容纳 std::packaged_task 以及捕获少量变量的 lambda
+using function_wrapper = basic_function_wrapper<64 - sizeof(void*), alignof(void*)>;
+
 #endif //CPP_CONCURRENCY_IN_ACTION_FUNCTION_WRAPPER_H
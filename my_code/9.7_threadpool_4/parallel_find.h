@@ -0,0 +1,203 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 基于线程池的并行查找（随机访问迭代器）：parallel_find / parallel_find_if / parallel_find_if_not /
+// parallel_any_of / parallel_all_of / parallel_none_of / parallel_mismatch，都返回按位置最靠前的结果
+// 与 8.9_parallel_find_1.cpp（每个线程一整块）和 8.10_parallel_find_2.cpp（std::async 递归）相比：
+// - 区间切成 find_chunk_size 个元素的小块，参与者（工作线程与调用者）通过一个共享的原子游标按顺序领取，
+//   因此靠前的块先被检查，最靠前的匹配会很早被发现
+// - 找到匹配时把它的位置以原子取最小值的方式记入 found；领取新块前读一次 found（relaxed），
+//   块的起点已经在 found 之后就不再领取——它后面的块都不可能给出更靠前的结果。
+//   起点在 found 之前、正在检查的块会检查完，所以结果一定是第一个匹配
+// - 不在每个元素上读 seq_cst 的 done_flag，块内是普通的循环；
+//   连续存储的算术类型按值查找、比较时，块内使用 SIMD 比较（一次比较 64 字节，再在命中的 64 字节内定位）
+// 谓词抛出异常时，其余参与者在领取下一块时停止，异常由调用者重新抛出
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_PARALLEL_FIND_H
+#define CPP_CONCURRENCY_IN_ACTION_PARALLEL_FIND_H
+
+#include "task_group.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// 每次领取的元素个数：16K 个 int 为 64KB，检查一块约几微秒，一次 fetch_add 的开销可以忽略，找到匹配后最多多检查这么多元素
+std::size_t const find_chunk_size = std::size_t(1) << 14;
+
+namespace parallel_find_detail{
+
+    template<class T>
+    constexpr bool simd_comparable_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+#if defined(__GNUC__)
+    // 在 [a, a + n) 中找第一个满足 cmp(a[i], b[i]) 的位置，b 每次前进 b_step 个元素（0 表示同一个值），没有则返回 n。
+    // 一次处理 4 个 16 字节向量，各自比较的结果按位或起来判断是否有命中，命中时在这 64 字节内逐个定位
+    template<class T, class VectorCompare, class ScalarCompare>
+    std::size_t simd_find(const T *a, const T *b, std::size_t b_step, std::size_t n, VectorCompare vcmp, ScalarCompare scmp){
+        typedef T vec __attribute__((vector_size(16)));
+        std::size_t const lanes = sizeof(vec) / sizeof(T);
+        std::size_t const block = lanes * 4;
+        std::size_t i = 0;
+        for(; i + block <= n; i += block){
+            vec va[4], vb[4];
+            std::memcpy(va, a + i, sizeof(va));
+            if(b_step){
+                std::memcpy(vb, b + i, sizeof(vb));
+            }else{
+                for(auto &v: vb){
+                    v = vec{} + *b;
+                }
+            }
+            auto const hit = vcmp(va[0], vb[0]) | vcmp(va[1], vb[1]) | vcmp(va[2], vb[2]) | vcmp(va[3], vb[3]);
+            std::uint64_t words[2];
+            std::memcpy(words, &hit, sizeof(words));
+            if(words[0] | words[1]){
+                break;
+            }
+        }
+        for(; i < n; ++i){
+            if(scmp(a[i], b[b_step ? i : 0])){
+                return i;
+            }
+        }
+        return n;
+    }
+#endif
+
+    // 按顺序领取块，返回第一个匹配的下标，没有则返回 n。scan(begin, end) 返回 [begin, end) 中第一个匹配的下标，没有则返回 end
+    template<class ScanChunk>
+    std::size_t find_first(thread_pool &tp, std::size_t n, ScanChunk scan){
+        std::size_t const chunk_num = (n + find_chunk_size - 1) / find_chunk_size;
+        if(chunk_num <= 1){
+            return n == 0 ? 0 : scan(0, n);
+        }
+
+        // 先由调用者检查第一块：匹配很靠前时不必唤醒其它线程
+        std::size_t const first_pos = scan(0, find_chunk_size);
+        if(first_pos != find_chunk_size){
+            return first_pos;
+        }
+
+        std::atomic<std::size_t> next_chunk(1);
+        std::atomic<std::size_t> found(n);
+        auto participate = [&](){
+            try{
+                for(;;){
+                    std::size_t const chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                    std::size_t const begin = chunk * find_chunk_size;
+                    if(chunk >= chunk_num || begin >= found.load(std::memory_order_relaxed)){
+                        return;
+                    }
+                    std::size_t const end = std::min(begin + find_chunk_size, n);
+                    std::size_t const pos = scan(begin, end);
+                    if(pos != end){
+                        // 取最小值：比当前块靠前的块可能也找到了匹配
+                        std::size_t current = found.load(std::memory_order_relaxed);
+                        while(pos < current && !found.compare_exchange_weak(current, pos, std::memory_order_relaxed)){
+                        }
+                        return;     // 自己之后领取的块都在 pos 之后
+                    }
+                }
+            }catch (...){
+                found.store(0, std::memory_order_relaxed);      // 让其它参与者停止
+                throw;
+            }
+        };
+
+        // 结果通过 task_group::wait 的同步对调用者可见
+        std::size_t const helpers = std::min<std::size_t>(tp.thread_count(), chunk_num - 2);
+        task_group group(tp);
+        for(std::size_t i = 0; i < helpers; ++i){
+            group.spawn(participate);
+        }
+        participate();
+        group.wait();
+        return found.load(std::memory_order_relaxed);
+    }
+}
+
+template<class Iterator, class Predicate>
+Iterator parallel_find_if(thread_pool &tp, Iterator first, Iterator last, Predicate pred){
+    static_assert(std::random_access_iterator<Iterator>, "parallel_find requires random-access iterators");
+    return first + parallel_find_detail::find_first(tp, last - first, [first, &pred](std::size_t begin, std::size_t end){
+        return static_cast<std::size_t>(std::find_if(first + begin, first + end, pred) - first);
+    });
+}
+
+template<class Iterator, class Predicate>
+Iterator parallel_find_if_not(thread_pool &tp, Iterator first, Iterator last, Predicate pred){
+    return parallel_find_if(tp, first, last, [&pred](const auto &x){ return !pred(x); });
+}
+
+template<class Iterator, class MatchType>
+Iterator parallel_find(thread_pool &tp, Iterator first, Iterator last, const MatchType &match){
+    static_assert(std::random_access_iterator<Iterator>, "parallel_find requires random-access iterators");
+    using value_type = std::iter_value_t<Iterator>;
+#if defined(__GNUC__)
+    if constexpr (std::contiguous_iterator<Iterator> && std::is_same_v<value_type, MatchType>
+                  && parallel_find_detail::simd_comparable_v<value_type>){
+        const value_type *data = std::to_address(first);
+        return first + parallel_find_detail::find_first(tp, last - first, [data, &match](std::size_t begin, std::size_t end){
+            return begin + parallel_find_detail::simd_find(data + begin, &match, 0, end - begin,
+                                                           [](auto a, auto b){ return a == b; },
+                                                           [](value_type a, value_type b){ return a == b; });
+        });
+    }
+#endif
+    return parallel_find_if(tp, first, last, [&match](const auto &x){ return x == match; });
+}
+
+template<class Iterator, class Predicate>
+bool parallel_any_of(thread_pool &tp, Iterator first, Iterator last, Predicate pred){
+    return parallel_find_if(tp, first, last, std::move(pred)) != last;
+}
+
+template<class Iterator, class Predicate>
+bool parallel_all_of(thread_pool &tp, Iterator first, Iterator last, Predicate pred){
+    return parallel_find_if_not(tp, first, last, std::move(pred)) == last;
+}
+
+template<class Iterator, class Predicate>
+bool parallel_none_of(thread_pool &tp, Iterator first, Iterator last, Predicate pred){
+    return parallel_find_if(tp, first, last, std::move(pred)) == last;
+}
+
+// 第一个使 pred(*it1, *it2) 为假的位置；第二个序列至少与第一个一样长
+template<class Iterator1, class Iterator2, class BinaryPredicate>
+std::pair<Iterator1, Iterator2> parallel_mismatch(thread_pool &tp, Iterator1 first1, Iterator1 last1, Iterator2 first2,
+                                                  BinaryPredicate pred){
+    static_assert(std::random_access_iterator<Iterator1> && std::random_access_iterator<Iterator2>,
+                  "parallel_mismatch requires random-access iterators");
+    std::size_t const pos = parallel_find_detail::find_first(tp, last1 - first1, [first1, first2, &pred](std::size_t begin, std::size_t end){
+        return begin + static_cast<std::size_t>(std::mismatch(first1 + begin, first1 + end, first2 + begin, pred).first - (first1 + begin));
+    });
+    return {first1 + pos, first2 + pos};
+}
+
+template<class Iterator1, class Iterator2>
+std::pair<Iterator1, Iterator2> parallel_mismatch(thread_pool &tp, Iterator1 first1, Iterator1 last1, Iterator2 first2){
+    using value_type = std::iter_value_t<Iterator1>;
+#if defined(__GNUC__)
+    if constexpr (std::contiguous_iterator<Iterator1> && std::contiguous_iterator<Iterator2>
+                  && std::is_same_v<value_type, std::iter_value_t<Iterator2>>
+                  && parallel_find_detail::simd_comparable_v<value_type>){
+        const value_type *a = std::to_address(first1), *b = std::to_address(first2);
+        std::size_t const pos = parallel_find_detail::find_first(tp, last1 - first1, [a, b](std::size_t begin, std::size_t end){
+            return begin + parallel_find_detail::simd_find(a + begin, b + begin, 1, end - begin,
+                                                           [](auto x, auto y){ return x != y; },
+                                                           [](value_type x, value_type y){ return !(x == y); });
+        });
+        return {first1 + pos, first2 + pos};
+    }
+#endif
+    return parallel_mismatch(tp, first1, last1, first2, std::equal_to<>());
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_PARALLEL_FIND_H
@@ -0,0 +1,130 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 基于线程池的归并：
+// - parallel_merge(tp, first1, last1, first2, last2, d_first, comp)：与 std::merge 相同的稳定归并（相等时先取第一个序列）。
+//   把输出均匀切成若干段，每个切点用二分查找求“共秩”（co-rank）：输出的前 k 个元素中有 i 个来自第一个序列、k - i 个来自第二个，
+//   于是各段互不依赖，可以并行地调用 std::merge
+// - multiway_merge(runs, d_first, comp)：用败者树把 k 个有序序列归并为一个，每输出一个元素只需 log2(k) 次比较；
+//   相等的元素按序列的下标先后输出，因此也是稳定的
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_PARALLEL_MERGE_H
+#define CPP_CONCURRENCY_IN_ACTION_PARALLEL_MERGE_H
+
+#include "task_group.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 每段输出至少包含的元素个数
+std::size_t const merge_grain_size = std::size_t(1) << 15;
+
+// 输出的前 k 个元素中来自 [first1, first1 + n1) 的个数（第二个序列长 n2）
+template<class Iterator1, class Iterator2, class Compare>
+std::size_t merge_co_rank(std::size_t k, Iterator1 first1, std::size_t n1, Iterator2 first2, std::size_t n2, Compare &comp){
+    // 找最大的 i，使得 first1[i - 1] 排在 first2[k - i] 之前（相等时第一个序列优先）
+    std::size_t lo = k > n2 ? k - n2 : 0, hi = std::min(k, n1);
+    while(lo < hi){
+        std::size_t const mid = (lo + hi + 1) / 2;
+        if(!comp(first2[k - mid], first1[mid - 1])){
+            lo = mid;
+        }else{
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+template<class Iterator1, class Iterator2, class OutputIt, class Compare = std::less<>>
+OutputIt parallel_merge(thread_pool &tp, Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+                        OutputIt d_first, Compare comp = Compare()){
+    // 输入可以是 std::move_iterator，它在 C++20 中只满足 input_iterator 概念，因此检查传统的迭代器类别
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator1>::iterator_category>
+                  && std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator2>::iterator_category>
+                  && std::random_access_iterator<OutputIt>, "parallel_merge requires random-access iterators");
+    std::size_t const n1 = last1 - first1, n2 = last2 - first2, total = n1 + n2;
+    std::size_t const max_parts = (total + merge_grain_size - 1) / merge_grain_size;
+    std::size_t const part_num = std::max<std::size_t>(1, std::min(max_parts, tp.thread_count() * 2));
+    if(part_num == 1){
+        return std::merge(first1, last1, first2, last2, d_first, comp);
+    }
+
+    auto merge_part = [&](std::size_t part){
+        std::size_t const k_begin = total * part / part_num, k_end = total * (part + 1) / part_num;
+        std::size_t const i_begin = merge_co_rank(k_begin, first1, n1, first2, n2, comp);
+        std::size_t const i_end = merge_co_rank(k_end, first1, n1, first2, n2, comp);
+        std::merge(first1 + i_begin, first1 + i_end, first2 + (k_begin - i_begin), first2 + (k_end - i_end),
+                   d_first + k_begin, comp);
+    };
+    task_group group(tp);
+    for(std::size_t part = 0; part + 1 < part_num; ++part){
+        group.spawn([&merge_part, part](){
+            merge_part(part);
+        });
+    }
+    merge_part(part_num - 1);
+    group.wait();
+    return d_first + total;
+}
+
+// 败者树 k 路归并：runs 中每一项是一个有序序列 [first, last)
+template<class Iterator, class OutputIt, class Compare = std::less<>>
+OutputIt multiway_merge(std::vector<std::pair<Iterator, Iterator>> runs, OutputIt d_first, Compare comp = Compare()){
+    std::size_t const k = runs.size();
+    if(k == 0){
+        return d_first;
+    }
+    if(k == 1){
+        return std::copy(runs[0].first, runs[0].second, d_first);
+    }
+
+    // 序列 a 的当前元素是否排在序列 b 的当前元素之前；已耗尽的序列排在最后，相等时下标小的在前
+    auto before = [&](std::size_t a, std::size_t b){
+        if(runs[a].first == runs[a].second){
+            return false;
+        }
+        if(runs[b].first == runs[b].second){
+            return true;
+        }
+        if(comp(*runs[b].first, *runs[a].first)){
+            return false;
+        }
+        return comp(*runs[a].first, *runs[b].first) || a < b;
+    };
+
+    // 隐式的完全二叉树：内部节点 1..k-1 保存比赛的败者，叶子 k..2k-1 对应各序列
+    std::vector<std::size_t> losers(k);
+    auto build = [&](auto &self, std::size_t node) -> std::size_t{
+        if(node >= k){
+            return node - k;
+        }
+        std::size_t const a = self(self, 2 * node), b = self(self, 2 * node + 1);
+        if(before(a, b)){
+            losers[node] = b;
+            return a;
+        }
+        losers[node] = a;
+        return b;
+    };
+    std::size_t winner = build(build, 1);
+
+    // 输出胜者，它的序列前进一步后沿着到根的路径重新比赛
+    while(runs[winner].first != runs[winner].second){
+        *d_first = *runs[winner].first;
+        ++d_first;
+        ++runs[winner].first;
+        for(std::size_t node = (winner + k) / 2; node >= 1; node /= 2){
+            if(before(losers[node], winner)){
+                std::swap(losers[node], winner);
+            }
+        }
+    }
+    return d_first;
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_PARALLEL_MERGE_H
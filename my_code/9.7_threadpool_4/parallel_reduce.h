@@ -0,0 +1,147 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 基于线程池的并行归约：parallel_reduce(tp, first, last, init, op) 和 parallel_accumulate(tp, first, last, init)
+// 与 2.9_parallel_accumulate.cpp 的区别：
+// - 不为每次调用创建线程，而是把数据块作为任务提交到已有的 thread_pool（task_group），调用者也参与执行
+// - 每个数据块的部分结果独占一个缓存行（padded_partial），相邻的块写结果时不会伪共享
+// - 块大小由 reduce_grain_size 决定（而不是 min_per_thread = 25）：一个块的计算时间要远大于一次任务调度的开销，
+//   块数又要足够多（最多 thread_count() * blocks_per_thread）以便负载均衡
+// - 连续存储的算术类型做加法时，块内使用 SIMD 内核（GCC/Clang 向量扩展，多个向量累加器掩盖加法延迟），
+//   使求和只受内存带宽限制
+// 与 std::reduce 一样，op 需要满足结合律；部分结果按块的顺序合并，因此不要求交换律。
+// 浮点数的 SIMD 求和改变了加法顺序，结果与顺序求和可能有舍入误差
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_PARALLEL_REDUCE_H
+#define CPP_CONCURRENCY_IN_ACTION_PARALLEL_REDUCE_H
+
+#include "task_group.h"
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+// 每个块至少包含的元素个数：32K 个 float 约 128KB，求和约需 10us，远大于一次任务调度（约 1us）
+std::size_t const reduce_grain_size = std::size_t(1) << 15;
+// 每个工作线程最多分到的块数，多于 1 是为了在线程速度不均时仍能负载均衡
+std::size_t const blocks_per_thread = 4;
+
+namespace parallel_reduce_detail{
+
+    // optional：T 不需要默认构造
+    template<class T>
+    struct alignas(64) padded_partial{
+        std::optional<T> value;
+    };
+
+    template<class Iterator, class T, class BinaryOp>
+    constexpr bool simd_sum_v = std::contiguous_iterator<Iterator>
+                                && std::is_same_v<std::iter_value_t<Iterator>, T>
+                                && std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+                                && (std::is_same_v<BinaryOp, std::plus<T>> || std::is_same_v<BinaryOp, std::plus<>>);
+
+    // 求 [data, data + n) 的和，n > 0
+    template<class T>
+    T simd_sum(const T *data, std::size_t n){
+#if defined(__GNUC__)
+        // 32 字节的向量：AVX 下是一条指令，只有 SSE/NEON 时由编译器拆成两条
+        typedef T vec __attribute__((vector_size(32)));
+        std::size_t const lanes = sizeof(vec) / sizeof(T);
+        std::size_t const unroll = 4;       // 4 个独立的累加器
+        vec acc[unroll] = {};
+        std::size_t i = 0;
+        for(; i + lanes * unroll <= n; i += lanes * unroll){
+            for(std::size_t u = 0; u < unroll; ++u){
+                vec v;
+                std::memcpy(&v, data + i + u * lanes, sizeof(vec));     // 不要求对齐
+                acc[u] += v;
+            }
+        }
+        acc[0] += acc[1];
+        acc[2] += acc[3];
+        acc[0] += acc[2];
+        T sum = acc[0][0];
+        for(std::size_t l = 1; l < lanes; ++l){
+            sum += acc[0][l];
+        }
+#else
+        T acc[4] = {};
+        std::size_t i = 0;
+        for(; i + 4 <= n; i += 4){
+            acc[0] += data[i];
+            acc[1] += data[i + 1];
+            acc[2] += data[i + 2];
+            acc[3] += data[i + 3];
+        }
+        T sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+        for(; i < n; ++i){
+            sum += data[i];
+        }
+        return sum;
+    }
+
+    // 归约一个非空的块
+    template<class Iterator, class T, class BinaryOp>
+    T reduce_block(Iterator first, Iterator last, BinaryOp &op){
+        if constexpr (simd_sum_v<Iterator, T, BinaryOp>){
+            return simd_sum(std::to_address(first), static_cast<std::size_t>(last - first));
+        }else{
+            T result = *first;
+            for(++first; first != last; ++first){
+                result = op(std::move(result), *first);
+            }
+            return result;
+        }
+    }
+}
+
+template<class Iterator, class T, class BinaryOp>
+T parallel_reduce(thread_pool &tp, Iterator first, Iterator last, T init, BinaryOp op){
+    using namespace parallel_reduce_detail;
+    std::size_t const length = std::distance(first, last);
+    if(length == 0){
+        return init;
+    }
+
+    // 确定块的数量
+    std::size_t const max_blocks = (length + reduce_grain_size - 1) / reduce_grain_size;
+    std::size_t const block_num = std::max<std::size_t>(1, std::min(max_blocks, tp.thread_count() * blocks_per_thread));
+    if(block_num == 1){
+        return op(std::move(init), reduce_block<Iterator, T>(first, last, op));
+    }
+
+    // 数据划分，前 length % block_num 个块多一个元素；最后一个块由调用者自己计算
+    std::size_t const block_size = length / block_num, remainder = length % block_num;
+    std::unique_ptr<padded_partial<T>[]> partials(new padded_partial<T>[block_num]);
+    task_group group(tp);
+    Iterator block_start = first;
+    for(std::size_t i = 0; i < block_num - 1; ++i){
+        Iterator block_end = block_start;
+        std::advance(block_end, block_size + (i < remainder ? 1 : 0));
+        group.spawn([block_start, block_end, &op, slot = &partials[i]](){
+            slot->value.emplace(reduce_block<Iterator, T>(block_start, block_end, op));
+        });
+        block_start = block_end;
+    }
+    partials[block_num - 1].value.emplace(reduce_block<Iterator, T>(block_start, last, op));
+    group.wait();
+
+    // 按块的顺序合并部分结果
+    T result = std::move(init);
+    for(std::size_t i = 0; i < block_num; ++i){
+        result = op(std::move(result), std::move(*partials[i].value));
+    }
+    return result;
+}
+
+template<class Iterator, class T>
+T parallel_accumulate(thread_pool &tp, Iterator first, Iterator last, T init){
+    return parallel_reduce(tp, first, last, std::move(init), std::plus<T>());
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_PARALLEL_REDUCE_H
@@ -0,0 +1,199 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 基于线程池的并行前缀和（随机访问迭代器）：parallel_inclusive_scan / parallel_exclusive_scan / parallel_partial_sum
+// 8.11_parallel_partial_sum.cpp 中每个块要等前一个块通过 promise/future 传来尾元素，进位在线程之间串行传递。
+// 这里采用两遍扫描（reduce-then-scan）：
+// 1. 并行求各块的归约值（块 0 直接由调用者完成扫描，顺便得到它的归约值）
+// 2. 顺序扫描各块的归约值，得到每个块的进位（块数只有 thread_count() * blocks_per_thread 个）
+// 3. 各块带着进位并行做块内扫描，直接写入结果
+// 每个元素读两次、写一次，且第一遍只读不写，因此 d_first 可以等于 first（原地扫描）。
+// 连续存储的算术类型做加法时，块内扫描使用 SIMD 内核：一个 16 字节向量内用 log2(lanes) 次移位相加求前缀，
+// 再加上广播的进位；第一遍的归约使用 parallel_reduce 的 SIMD 求和内核。
+// op 需要满足结合律；与 std::inclusive_scan 一样，浮点数的结果可能与顺序计算有舍入误差
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_PARALLEL_SCAN_H
+#define CPP_CONCURRENCY_IN_ACTION_PARALLEL_SCAN_H
+
+#include "parallel_reduce.h"
+#include <cstdint>
+
+namespace parallel_scan_detail{
+
+    // 一个 16 字节向量至少要有两个元素，long double（16 字节）走标量路径
+    template<class InputIt, class OutputIt, class T, class BinaryOp>
+    constexpr bool simd_scan_v = parallel_reduce_detail::simd_sum_v<InputIt, T, BinaryOp>
+                                 && sizeof(T) <= 8
+                                 && std::contiguous_iterator<OutputIt>
+                                 && std::is_same_v<std::iter_value_t<OutputIt>, T>;
+
+#if defined(__GNUC__) && !defined(__clang__)
+    // 16 字节向量：没有 AVX 时 32 字节的通用向量会被拆开，移位操作反而比标量慢
+    template<class T>
+    struct simd_prefix{
+        typedef T vec __attribute__((vector_size(16)));
+        using mask_element = std::conditional_t<sizeof(T) == 1, std::int8_t,
+                             std::conditional_t<sizeof(T) == 2, std::int16_t,
+                             std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>>>;
+        typedef mask_element mask __attribute__((vector_size(16)));
+        static constexpr std::size_t lanes = sizeof(vec) / sizeof(T);
+
+        // 各元素向高位移动 k 个位置，低位补 0（shuffle 的下标 >= lanes 时取第二个向量，即 0）
+        template<std::size_t k>
+        static inline vec shift_up(vec v){
+            mask m;
+            for(std::size_t l = 0; l < lanes; ++l){
+                m[l] = l >= k ? mask_element(l - k) : mask_element(lanes);
+            }
+            return __builtin_shuffle(v, vec{}, m);
+        }
+
+        template<std::size_t k = 1>
+        static inline vec prefix(vec v){
+            if constexpr (k < lanes){
+                v += shift_up<k>(v);
+                return prefix<k * 2>(v);
+            }else{
+                return v;
+            }
+        }
+    };
+#endif
+
+    // 扫描 [in, in + n)，进位为 carry，返回 carry 与所有元素之和
+    template<class T>
+    T simd_scan(const T *in, T *out, std::size_t n, T carry, bool inclusive){
+        std::size_t i = 0;
+#if defined(__GNUC__) && !defined(__clang__)
+        using simd = simd_prefix<T>;
+        typename simd::vec c = typename simd::vec{} + carry;
+        for(; i + simd::lanes <= n; i += simd::lanes){
+            typename simd::vec v;
+            std::memcpy(&v, in + i, sizeof(v));      // 先读后写，允许 in == out
+            typename simd::vec const p = simd::prefix(v);
+            typename simd::vec const r = (inclusive ? p : simd::template shift_up<1>(p)) + c;
+            std::memcpy(out + i, &r, sizeof(r));
+            carry += p[simd::lanes - 1];
+            c = typename simd::vec{} + carry;
+        }
+#endif
+        for(; i < n; ++i){
+            T const x = in[i];
+            if(inclusive){
+                carry += x;
+                out[i] = carry;
+            }else{
+                out[i] = carry;
+                carry += x;
+            }
+        }
+        return carry;
+    }
+
+    // 扫描一个非空的块。carry 为空表示整个序列的第一个块且没有初值（只用于 inclusive）。返回本块结束时的累计值
+    template<class T, class InputIt, class OutputIt, class BinaryOp>
+    T scan_block(InputIt first, InputIt last, OutputIt d_first, BinaryOp &op, std::optional<T> carry, bool inclusive){
+        if constexpr (simd_scan_v<InputIt, OutputIt, T, BinaryOp>){
+            return simd_scan(std::to_address(first), std::to_address(d_first), static_cast<std::size_t>(last - first),
+                             carry ? *carry : T(), inclusive);
+        }else{
+            if(!carry){
+                carry.emplace(*first);
+                *d_first = *carry;
+                ++first;
+                ++d_first;
+            }
+            T acc = std::move(*carry);
+            for(; first != last; ++first, ++d_first){
+                if(inclusive){
+                    acc = op(std::move(acc), *first);
+                    *d_first = acc;
+                }else{
+                    T next = op(acc, *first);
+                    *d_first = std::move(acc);
+                    acc = std::move(next);
+                }
+            }
+            return acc;
+        }
+    }
+
+    template<class T, class InputIt, class OutputIt, class BinaryOp>
+    OutputIt parallel_scan(thread_pool &tp, InputIt first, InputIt last, OutputIt d_first, BinaryOp op,
+                           std::optional<T> init, bool inclusive){
+        static_assert(std::random_access_iterator<InputIt> && std::random_access_iterator<OutputIt>,
+                      "parallel scan requires random-access iterators");
+        std::size_t const length = last - first;
+        if(length == 0){
+            return d_first;
+        }
+
+        // 确定块的数量，与 parallel_reduce 相同。两遍扫描比顺序扫描多读一遍数据，只有一个工作线程时直接顺序扫描
+        std::size_t const max_blocks = (length + reduce_grain_size - 1) / reduce_grain_size;
+        std::size_t const block_num = tp.thread_count() <= 1 ? 1
+                                      : std::max<std::size_t>(1, std::min(max_blocks, tp.thread_count() * blocks_per_thread));
+        std::size_t const block_size = length / block_num, remainder = length % block_num;
+        auto block_begin = [&](std::size_t i){
+            return i * block_size + std::min(i, remainder);
+        };
+        if(block_num == 1){
+            scan_block<T>(first, last, d_first, op, std::move(init), inclusive);
+            return d_first + length;
+        }
+
+        // 第一遍：块 0 直接扫描，其余块（最后一块除外，它的归约值用不到）并行归约
+        std::unique_ptr<parallel_reduce_detail::padded_partial<T>[]> carries(
+                new parallel_reduce_detail::padded_partial<T>[block_num]);
+        task_group group(tp);
+        for(std::size_t i = 1; i + 1 < block_num; ++i){
+            group.spawn([first, &op, begin = block_begin(i), end = block_begin(i + 1), slot = &carries[i]](){
+                slot->value.emplace(parallel_reduce_detail::reduce_block<InputIt, T>(first + begin, first + end, op));
+            });
+        }
+        carries[0].value.emplace(scan_block<T>(first, first + block_begin(1), d_first, op, std::move(init), inclusive));
+        group.wait();
+
+        // 第二遍：顺序求每个块的进位，carries[i] 变为块 0..i 的累计值
+        for(std::size_t i = 1; i + 1 < block_num; ++i){
+            carries[i].value.emplace(op(*carries[i - 1].value, std::move(*carries[i].value)));  // carries[i - 1] 第三遍还要用
+        }
+
+        // 第三遍：块 1..block_num-1 带着前一块的累计值并行扫描，最后一块由调用者完成
+        for(std::size_t i = 1; i + 1 < block_num; ++i){
+            group.spawn([first, d_first, &op, inclusive, begin = block_begin(i), end = block_begin(i + 1), slot = &carries[i - 1]](){
+                scan_block<T>(first + begin, first + end, d_first + begin, op, std::optional<T>(*slot->value), inclusive);
+            });
+        }
+        std::size_t const last_begin = block_begin(block_num - 1);
+        scan_block<T>(first + last_begin, last, d_first + last_begin, op, std::optional<T>(*carries[block_num - 2].value), inclusive);
+        group.wait();
+        return d_first + length;
+    }
+}
+
+// 包含当前元素的前缀：d_first[i] = init op first[0] op ... op first[i]
+template<class InputIt, class OutputIt, class BinaryOp, class T>
+OutputIt parallel_inclusive_scan(thread_pool &tp, InputIt first, InputIt last, OutputIt d_first, BinaryOp op, T init){
+    return parallel_scan_detail::parallel_scan<T>(tp, first, last, d_first, std::move(op), std::optional<T>(std::move(init)), true);
+}
+
+template<class InputIt, class OutputIt, class BinaryOp = std::plus<>>
+OutputIt parallel_inclusive_scan(thread_pool &tp, InputIt first, InputIt last, OutputIt d_first, BinaryOp op = BinaryOp()){
+    using T = std::iter_value_t<InputIt>;
+    return parallel_scan_detail::parallel_scan<T>(tp, first, last, d_first, std::move(op), std::optional<T>(), true);
+}
+
+// 不包含当前元素的前缀：d_first[0] = init，d_first[i] = init op first[0] op ... op first[i - 1]
+template<class InputIt, class OutputIt, class T, class BinaryOp = std::plus<>>
+OutputIt parallel_exclusive_scan(thread_pool &tp, InputIt first, InputIt last, OutputIt d_first, T init, BinaryOp op = BinaryOp()){
+    return parallel_scan_detail::parallel_scan<T>(tp, first, last, d_first, std::move(op), std::optional<T>(std::move(init)), false);
+}
+
+// 8.11 中 parallel_partial_sum 的线程池版本：原地求和
+template<class Iterator>
+void parallel_partial_sum(thread_pool &tp, Iterator first, Iterator last){
+    parallel_inclusive_scan(tp, first, last, first);
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_PARALLEL_SCAN_H
@@ -0,0 +1,190 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 基于线程池的原地并行快速排序（随机访问迭代器）：parallel_sort(tp, first, last, comp)
+// 与 4.12_quick_sort.cpp / 8.1_quick_sort_thread_pool.cpp 中对 std::list 的快速排序相比：
+// - 原地划分连续的数组，而不是摘取、拼接链表节点
+// - 基准取抽样的中位数：小区间取 3 个元素的中位数，大区间取 sort_sample_size 个均匀抽样元素的中位数，
+//   有序、逆序的输入不会退化成 O(n^2)
+// - 大区间（parallel_partition_cutoff 以上）的划分本身也是并行的：各块先在块内划分，再把放错一侧的元素成对交换
+// - 与基准相等的元素很多时（基准是区间最小值），再把等于基准的元素单独划出来，不再参与递归
+// - 区间小于 sort_cutoff 时直接调用 std::sort；递归深度超过 2 * log2(n) 时也改用 std::sort，保证 O(n log n)
+// - 左半部分通过 task_group::spawn 提交到任务窃取线程池，当前线程继续处理右半部分，
+//   所有子任务共用一个 task_group（一个原子计数器），不为每个块分配 promise/future
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_PARALLEL_SORT_H
+#define CPP_CONCURRENCY_IN_ACTION_PARALLEL_SORT_H
+
+#include "task_group.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// 小于它的区间直接用 std::sort：16K 个元素的排序约需 0.5ms，远大于一次任务调度的开销
+std::size_t const sort_cutoff = std::size_t(1) << 14;
+// 大于它的区间并行划分
+std::size_t const parallel_partition_cutoff = std::size_t(1) << 20;
+// 大区间取基准时的抽样个数（奇数）
+std::size_t const sort_sample_size = 63;
+
+namespace parallel_sort_detail{
+
+    // 选出基准并交换到 *first
+    template<class Iterator, class Compare>
+    void choose_pivot(Iterator first, Iterator last, Compare &comp){
+        std::size_t const n = last - first;
+        std::size_t const samples = n >= sort_cutoff * 4 ? sort_sample_size : 3;
+        Iterator sample[sort_sample_size];
+        for(std::size_t i = 0; i < samples; ++i){
+            sample[i] = first + (n - 1) * (2 * i + 1) / (2 * samples);
+        }
+        std::nth_element(sample, sample + samples / 2, sample + samples, [&comp](Iterator a, Iterator b){
+            return comp(*a, *b);
+        });
+        std::iter_swap(first, sample[samples / 2]);
+    }
+
+    // 并行划分 [first, last)，pred 为真的元素放到前面，返回分界点
+    template<class Iterator, class Predicate>
+    Iterator parallel_partition(thread_pool &tp, Iterator first, Iterator last, Predicate pred){
+        std::size_t const n = last - first;
+        std::size_t const block_num = std::max<std::size_t>(1, std::min<std::size_t>(tp.thread_count() * 2, n / sort_cutoff));
+        std::size_t const block_size = n / block_num;
+        auto block_begin = [&](std::size_t i){
+            return i == block_num ? n : i * block_size;
+        };
+
+        // 1. 块内划分，记录每块中 pred 为真的元素个数
+        std::vector<std::size_t> true_count(block_num);
+        {
+            task_group group(tp);
+            for(std::size_t i = 0; i + 1 < block_num; ++i){
+                group.spawn([&, i](){
+                    true_count[i] = std::partition(first + block_begin(i), first + block_begin(i + 1), pred) - (first + block_begin(i));
+                });
+            }
+            std::size_t const i = block_num - 1;
+            true_count[i] = std::partition(first + block_begin(i), last, pred) - (first + block_begin(i));
+            group.wait();
+        }
+
+        // 2. 分界点之前的“假”区间与之后的“真”区间一样多，按顺序一一对应
+        std::size_t total_true = 0;
+        for(std::size_t c: true_count){
+            total_true += c;
+        }
+        struct interval{
+            std::size_t begin, end;
+        };
+        std::vector<interval> wrong_false, wrong_true;      // 分界点前的假元素、分界点后的真元素
+        for(std::size_t i = 0; i < block_num; ++i){
+            std::size_t const b = block_begin(i), m = b + true_count[i], e = block_begin(i + 1);
+            if(m < std::min(e, total_true)){
+                wrong_false.push_back({m, std::min(e, total_true)});
+            }
+            if(std::max(b, total_true) < m){
+                wrong_true.push_back({std::max(b, total_true), m});
+            }
+        }
+        std::vector<std::size_t> false_prefix(wrong_false.size() + 1, 0), true_prefix(wrong_true.size() + 1, 0);
+        for(std::size_t i = 0; i < wrong_false.size(); ++i){
+            false_prefix[i + 1] = false_prefix[i] + (wrong_false[i].end - wrong_false[i].begin);
+        }
+        for(std::size_t i = 0; i < wrong_true.size(); ++i){
+            true_prefix[i + 1] = true_prefix[i] + (wrong_true[i].end - wrong_true[i].begin);
+        }
+        std::size_t const wrong = false_prefix.back();
+
+        // 3. 把第 k 个放错的假元素与第 k 个放错的真元素交换，按 k 分块并行
+        auto swap_range = [&](std::size_t from, std::size_t to){
+            std::size_t fi = std::upper_bound(false_prefix.begin(), false_prefix.end(), from) - false_prefix.begin() - 1;
+            std::size_t ti = std::upper_bound(true_prefix.begin(), true_prefix.end(), from) - true_prefix.begin() - 1;
+            std::size_t fpos = wrong_false[fi].begin + (from - false_prefix[fi]);
+            std::size_t tpos = wrong_true[ti].begin + (from - true_prefix[ti]);
+            for(std::size_t k = from; k < to; ++k){
+                if(fpos == wrong_false[fi].end){
+                    fpos = wrong_false[++fi].begin;
+                }
+                if(tpos == wrong_true[ti].end){
+                    tpos = wrong_true[++ti].begin;
+                }
+                std::iter_swap(first + fpos++, first + tpos++);
+            }
+        };
+        if(wrong > 0){
+            std::size_t const swap_blocks = std::max<std::size_t>(1, std::min(block_num, wrong / sort_cutoff));
+            task_group group(tp);
+            for(std::size_t i = 0; i + 1 < swap_blocks; ++i){
+                group.spawn([&, i](){
+                    swap_range(wrong * i / swap_blocks, wrong * (i + 1) / swap_blocks);
+                });
+            }
+            swap_range(wrong * (swap_blocks - 1) / swap_blocks, wrong);
+            group.wait();
+        }
+        return first + total_true;
+    }
+
+    template<class Iterator, class Compare>
+    void sort_range(thread_pool &tp, task_group &group, Iterator first, Iterator last, Compare &comp, unsigned depth){
+        while(static_cast<std::size_t>(last - first) > sort_cutoff){
+            if(depth == 0){
+                std::sort(first, last, comp);
+                return;
+            }
+            --depth;
+
+            choose_pivot(first, last, comp);
+            auto const &pivot = *first;
+            auto const less = [&](const auto &x){ return comp(x, pivot); };
+            Iterator middle;
+            if(tp.thread_count() > 1 && static_cast<std::size_t>(last - first) > parallel_partition_cutoff){
+                middle = parallel_partition(tp, first + 1, last, less);
+            }else{
+                middle = std::partition(first + 1, last, less);
+            }
+            // [first + 1, middle) < pivot <= [middle, last)，把基准放到分界点
+            --middle;
+            std::iter_swap(first, middle);
+            Iterator right = middle + 1;
+            if(middle == first){
+                // 基准是最小值：等于基准的元素可能很多，把它们划出来，不再参与排序
+                auto const equal = [&](const auto &x){ return !comp(*first, x); };
+                right = static_cast<std::size_t>(last - right) > parallel_partition_cutoff && tp.thread_count() > 1
+                        ? parallel_partition(tp, right, last, equal)
+                        : std::partition(right, last, equal);
+            }
+
+            if(middle - first > 1){
+                group.spawn([&tp, &group, first, middle, &comp, depth](){
+                    sort_range(tp, group, first, middle, comp, depth);
+                });
+            }
+            first = right;
+        }
+        std::sort(first, last, comp);
+    }
+}
+
+template<class Iterator, class Compare = std::less<>>
+void parallel_sort(thread_pool &tp, Iterator first, Iterator last, Compare comp = Compare()){
+    static_assert(std::random_access_iterator<Iterator>, "parallel_sort requires random-access iterators");
+    std::size_t const n = last - first;
+    if(n <= sort_cutoff){
+        std::sort(first, last, comp);
+        return;
+    }
+    unsigned depth = 0;
+    for(std::size_t m = n; m > 1; m >>= 1){
+        depth += 2;
+    }
+    task_group group(tp);
+    parallel_sort_detail::sort_range(tp, group, first, last, comp, depth);
+    group.wait();
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_PARALLEL_SORT_H
@@ -0,0 +1,162 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 基于线程池的并行稳定排序（随机访问迭代器）：parallel_stable_sort(tp, first, last, comp)
+// 1. 把区间切成 2^L 段（约等于线程数，每段至少 stable_sort_cutoff 个元素），各段并行地做归并排序：
+//    先对每个小块插入排序，再借用缓冲区中与该段对应的部分逐轮 std::merge（std::stable_sort 会自己另外分配缓冲区）
+// 2. 自底向上两两归并 L 轮，每一轮的每一对都用 parallel_merge（共秩切分）并行归并，
+//    因此最后几轮只有一两对时仍能用满所有线程
+// 数据在原区间与一个辅助缓冲区之间来回移动，整个排序只分配这一个缓冲区；
+// L 为奇数时，第 1 步排好的段应当落在缓冲区，保证最后一轮归并的结果落在原区间，不需要再拷贝回来。
+// 区间太小、不切段时直接调用 std::stable_sort，此时由它分配自己的缓冲区。
+// 元素类型需要可默认构造（用于分配缓冲区）和可移动赋值
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_PARALLEL_STABLE_SORT_H
+#define CPP_CONCURRENCY_IN_ACTION_PARALLEL_STABLE_SORT_H
+
+#include "parallel_merge.h"
+
+// 小于它的区间直接用 std::stable_sort
+std::size_t const stable_sort_cutoff = std::size_t(1) << 14;
+
+// 段内归并排序的小块大小（插入排序的区间长度上限）
+std::size_t const stable_sort_block = 32;
+
+namespace parallel_stable_sort_detail{
+
+    template<class Iterator, class Compare>
+    void insertion_sort(Iterator first, Iterator last, Compare &comp){
+        for(Iterator i = first; i != last; ++i){
+            auto value = std::move(*i);
+            Iterator j = i;
+            for(; j != first && comp(value, *(j - 1)); --j){
+                *j = std::move(*(j - 1));
+            }
+            *j = std::move(value);
+        }
+    }
+
+    // 把 [src, src + n) 中长度为 width 的相邻有序段两两归并到 dst
+    template<class Source, class Destination, class Compare>
+    void merge_pass(Source src, Destination dst, std::size_t n, std::size_t width, Compare &comp){
+        for(std::size_t i = 0; i < n; i += 2 * width){
+            std::size_t const mid = std::min(i + width, n);
+            std::size_t const end = std::min(i + 2 * width, n);
+            std::merge(std::make_move_iterator(src + i), std::make_move_iterator(src + mid),
+                       std::make_move_iterator(src + mid), std::make_move_iterator(src + end), dst + i, comp);
+        }
+    }
+
+    // 稳定地排序 [first, first + n)，buf 是缓冲区中对应的部分，结果落在原区间（to_buffer 为 false）或 buf 中。
+    // 归并轮数的奇偶决定结果的位置：与要求不符时把小块减半，多归并一轮，省掉最后的整段移动
+    template<class Iterator, class BufferIterator, class Compare>
+    void sort_run(Iterator first, std::size_t n, BufferIterator buf, bool to_buffer, Compare &comp){
+        auto passes = [n](std::size_t block){
+            unsigned res = 0;
+            for(std::size_t width = block; width < n; width *= 2){
+                ++res;
+            }
+            return res;
+        };
+        std::size_t block = stable_sort_block;
+        if((passes(block) % 2 == 1) != to_buffer){
+            block /= 2;
+        }
+        for(std::size_t i = 0; i < n; i += block){
+            insertion_sort(first + i, first + std::min(i + block, n), comp);
+        }
+        bool in_buffer = false;
+        for(std::size_t width = block; width < n; width *= 2){
+            if(in_buffer){
+                merge_pass(buf, first, n, width, comp);
+            }else{
+                merge_pass(first, buf, n, width, comp);
+            }
+            in_buffer = !in_buffer;
+        }
+        if(in_buffer != to_buffer){     // 只有段短到不需要归并时才会发生
+            if(in_buffer){
+                std::move(buf, buf + n, first);
+            }else{
+                std::move(first, first + n, buf);
+            }
+        }
+    }
+
+    // 把 [src, src + n) 中 runs 个相邻的有序段两两归并到 dst，段的边界为 bounds（runs + 1 个）
+    template<class Source, class Destination, class Compare>
+    void merge_level(thread_pool &tp, Source src, Destination dst, const std::vector<std::size_t> &bounds,
+                     std::size_t runs, Compare &comp){
+        task_group group(tp);
+        for(std::size_t r = 0; r + 2 < runs; r += 2){
+            group.spawn([&tp, src, dst, &bounds, r, &comp](){
+                parallel_merge(tp, std::make_move_iterator(src + bounds[r]), std::make_move_iterator(src + bounds[r + 1]),
+                               std::make_move_iterator(src + bounds[r + 1]), std::make_move_iterator(src + bounds[r + 2]),
+                               dst + bounds[r], comp);
+            });
+        }
+        std::size_t const r = runs - 2;
+        parallel_merge(tp, std::make_move_iterator(src + bounds[r]), std::make_move_iterator(src + bounds[r + 1]),
+                       std::make_move_iterator(src + bounds[r + 1]), std::make_move_iterator(src + bounds[r + 2]),
+                       dst + bounds[r], comp);
+        group.wait();
+    }
+}
+
+template<class Iterator, class Compare = std::less<>>
+void parallel_stable_sort(thread_pool &tp, Iterator first, Iterator last, Compare comp = Compare()){
+    static_assert(std::random_access_iterator<Iterator>, "parallel_stable_sort requires random-access iterators");
+    using value_type = std::iter_value_t<Iterator>;
+    std::size_t const n = last - first;
+
+    // 段数取不小于线程数的 2 的幂，但每段不少于 stable_sort_cutoff 个元素
+    unsigned levels = 0;
+    while((std::size_t(1) << levels) < tp.thread_count() && (n >> (levels + 1)) >= stable_sort_cutoff){
+        ++levels;
+    }
+    if(levels == 0){
+        std::stable_sort(first, last, comp);
+        return;
+    }
+    std::size_t runs = std::size_t(1) << levels;
+    std::vector<std::size_t> bounds(runs + 1);
+    for(std::size_t r = 0; r <= runs; ++r){
+        bounds[r] = n * r / runs;
+    }
+    std::vector<value_type> buffer(n);
+    bool const start_in_buffer = levels % 2 == 1;
+
+    // 1. 各段并行排序
+    {
+        auto sort_run = [&](std::size_t r){
+            parallel_stable_sort_detail::sort_run(first + bounds[r], bounds[r + 1] - bounds[r], buffer.begin() + bounds[r],
+                                                  start_in_buffer, comp);
+        };
+        task_group group(tp);
+        for(std::size_t r = 0; r + 1 < runs; ++r){
+            group.spawn([&sort_run, r](){
+                sort_run(r);
+            });
+        }
+        sort_run(runs - 1);
+        group.wait();
+    }
+
+    // 2. 逐轮两两归并，在缓冲区与原区间之间交替
+    bool in_buffer = start_in_buffer;
+    while(runs > 1){
+        if(in_buffer){
+            parallel_stable_sort_detail::merge_level(tp, buffer.begin(), first, bounds, runs, comp);
+        }else{
+            parallel_stable_sort_detail::merge_level(tp, first, buffer.begin(), bounds, runs, comp);
+        }
+        in_buffer = !in_buffer;
+        runs /= 2;
+        for(std::size_t r = 0; r <= runs; ++r){
+            bounds[r] = bounds[2 * r];
+        }
+    }
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_PARALLEL_STABLE_SORT_H
@@ -0,0 +1,97 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 线程池全局队列：互斥锁保护的可增长环形数组
+// 与 threadsafe_queue 不同，任务直接存放在数组槽位中，入队不需要为每个任务分配节点和 shared_ptr，
+// 数组只在容量不够时翻倍，预热之后 push / try_pop 都不分配堆内存
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_POOL_QUEUE_H
+#define CPP_CONCURRENCY_IN_ACTION_POOL_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+template<class T>
+class pool_queue{
+public:
+    // initial_capacity 必须是2的幂
+    explicit pool_queue(std::size_t initial_capacity = 64):
+        slots(new T[initial_capacity]), capacity(initial_capacity){}
+    pool_queue(const pool_queue &other) = delete;
+    pool_queue& operator=(const pool_queue &other) = delete;
+
+    void push(T new_value){
+        std::lock_guard<std::mutex> lock(mtx);
+        reserve(count + 1);
+        slots[(head + count) & (capacity - 1)] = std::move(new_value);
+        count_hint.store(++count, std::memory_order_relaxed);
+    }
+
+    // 批量入队：只加一次锁
+    template<class Iterator>
+    void push_batch(Iterator first, Iterator last){
+        std::size_t const n = std::distance(first, last);
+        if(n == 0){
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        reserve(count + n);
+        for(; first != last; ++first){
+            slots[(head + count++) & (capacity - 1)] = std::move(*first);
+        }
+        count_hint.store(count, std::memory_order_relaxed);
+    }
+
+    bool try_pop(T &val){
+        if(count_hint.load(std::memory_order_relaxed) == 0){     // 空闲线程反复探测时不必加锁
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        if(count == 0){
+            return false;
+        }
+        val = std::move(slots[head]);
+        head = (head + 1) & (capacity - 1);
+        count_hint.store(--count, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 加锁读取，与 push 之间有同步关系（工作线程睡眠前用它做最后一次检查）
+    bool empty(){
+        std::lock_guard<std::mutex> lock(mtx);
+        return count == 0;
+    }
+
+private:
+    std::mutex mtx;
+    std::unique_ptr<T[]> slots;
+    std::size_t capacity;
+    std::size_t head = 0;
+    std::size_t count = 0;
+    std::atomic<std::size_t> count_hint{0};     // count 的副本，只用于不加锁的快速判空
+
+    // 调用前已经加锁。容量不够时翻倍，并把 [head, head + count) 依次搬到新数组的开头
+    void reserve(std::size_t required){
+        if(required <= capacity){
+            return;
+        }
+        std::size_t new_capacity = capacity;
+        while(new_capacity < required){
+            new_capacity *= 2;
+        }
+        std::unique_ptr<T[]> grown(new T[new_capacity]);
+        for(std::size_t i = 0; i < count; ++i){
+            grown[i] = std::move(slots[(head + i) & (capacity - 1)]);
+        }
+        slots = std::move(grown);
+        capacity = new_capacity;
+        head = 0;
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_POOL_QUEUE_H
@@ -0,0 +1,75 @@
+//
+// Created by chen on 2026/10/18.
+//
+// work_stealing_queue 压力测试：
+// 一个本地线程不断 push / try_pop，多个窃取线程不断 try_steal，
+// 最后检查每个任务恰好被执行了一次（没有丢失，也没有重复执行）
+
+#include "work_stealing_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main(){
+    int const task_count = 1000000;
+    unsigned const thief_count = std::max(2u, std::thread::hardware_concurrency());
+
+    std::vector<std::atomic<int>> run_count(task_count);
+    std::atomic<int> finished(0);
+    std::atomic<bool> owner_done(false);
+    work_stealing_queue queue(4);   // 初始容量设得很小，让扩容也参与测试
+
+    auto run = [&](function_wrapper &task){
+        task();
+        finished.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> thieves;
+    for(unsigned i = 0; i < thief_count; ++i){
+        thieves.emplace_back([&]{
+            function_wrapper task;
+            while(!owner_done.load() || !queue.empty()){
+                if(queue.try_steal(task)){
+                    run(task);
+                }
+            }
+        });
+    }
+
+    // 本地线程：每 push 3 个任务 pop 1 个，队列长度会不断增长，从而触发扩容
+    function_wrapper task;
+    for(int i = 0; i < task_count; ++i){
+        queue.push([&run_count, i]{
+            run_count[i].fetch_add(1, std::memory_order_relaxed);
+        });
+        if(i % 3 == 0 && queue.try_pop(task)){
+            run(task);
+        }
+    }
+    while(queue.try_pop(task)){
+        run(task);
+    }
+    owner_done = true;
+    for(auto &t: thieves){
+        t.join();
+    }
+
+    int lost = 0, duplicated = 0;
+    for(auto &c: run_count){
+        int const n = c.load();
+        if(n == 0){
+            ++lost;
+        }else if(n > 1){
+            ++duplicated;
+        }
+    }
+    std::cout << "tasks: " << task_count << ", finished: " << finished.load()
+              << ", lost: " << lost << ", duplicated: " << duplicated << std::endl;
+    if(lost == 0 && duplicated == 0 && finished.load() == task_count){
+        std::cout << "check." << std::endl;
+        return 0;
+    }
+    return 1;
+}
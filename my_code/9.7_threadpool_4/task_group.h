@@ -0,0 +1,103 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 基于任务窃取线程池的 fork/join：spawn(f) 派生子任务，wait() 等待本组所有子任务完成
+// - 用一个原子计数器跟踪未完成的子任务，而不是每个子任务一个 std::future；计数器中另有一位标记是否有睡眠的等待者
+// - 工作线程在 wait() 中不会阻塞，而是继续执行其它待处理任务（优先执行本地队列中刚派生的子任务），
+//   因此递归的分治算法只会使用线程池中固定数量的线程，不会出现线程爆炸
+// - 其它线程（包括别的线程池的工作线程）调用 wait() 时，在没有任务可帮忙执行后睡眠在线程池的 completion_event 上，
+//   直到最后一个子任务完成
+// 注意：子任务采用“派生即入队”（child stealing）的方式，窃取者拿到的是子任务而非父任务的后续部分
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_TASK_GROUP_H
+#define CPP_CONCURRENCY_IN_ACTION_TASK_GROUP_H
+
+#include "threadpool.h"
+#include <atomic>
+#include <exception>
+#include <thread>
+
+class task_group{
+public:
+    explicit task_group(thread_pool &tp_): tp(tp_), pending(0), failed(false){}
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+    // 析构前必须等待所有子任务完成，因为子任务持有指向本对象的指针
+    ~task_group(){
+        wait_for_children();
+    }
+
+    template<class Function>
+    void spawn(Function f){
+        pending.fetch_add(1, std::memory_order_relaxed);
+        // 最后一个子任务把计数减到0之后，等待者可能立即析构本对象，
+        // 因此之后只能访问寿命更长的线程池（通过提前拷贝的指针）
+        tp.post([this, pool = &tp, f]() mutable{
+            try{
+                f();
+            }catch (...){
+                if(!failed.exchange(true)){
+                    error = std::current_exception();
+                }
+            }
+            // 只有本组登记了睡眠的等待者时才通知，否则不去唤醒其它任务组的等待者
+            if(pending.fetch_sub(1, std::memory_order_acq_rel) == (waiter_bit | 1)){
+                pool->completion_event().notify_all();
+            }
+        });
+    }
+
+    // 等待所有子任务完成。若有子任务抛出异常，重新抛出第一个异常
+    void wait(){
+        wait_for_children();
+        if(failed.exchange(false)){
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    thread_pool &tp;
+    // 低位是未完成的子任务数；waiter_bit 表示有等待者准备睡眠在 completion_event 上。
+    // 二者放在同一个原子变量中，最后一个子任务从减到0的那一次操作就能知道是否需要通知，之后不必再访问本对象
+    std::atomic<long> pending;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+
+    static constexpr unsigned spin_rounds = 64;
+    static constexpr long waiter_bit = 1L << (sizeof(long) * 8 - 2);
+
+    void wait_for_children(){
+        unsigned idle_rounds = 0;
+        while(true){
+            long const n = pending.load(std::memory_order_acquire);
+            if((n & ~waiter_bit) == 0){
+                if(n != 0){     // 清除等待者标记，任务组可以继续使用
+                    pending.fetch_and(~waiter_bit, std::memory_order_relaxed);
+                }
+                return;
+            }
+            if(tp.try_run_pending_task()){
+                idle_rounds = 0;
+            }else if(idle_rounds < spin_rounds){
+                ++idle_rounds;
+                thread_pool::cpu_relax();
+            }else if(tp.owns_current_thread()){
+                std::this_thread::yield();      // 本线程池的工作线程不阻塞，随时准备执行新出现的任务
+            }else{
+                event_count &ec = tp.completion_event();
+                auto const key = ec.prepare_wait();
+                if((pending.fetch_or(waiter_bit, std::memory_order_acq_rel) & ~waiter_bit) == 0){
+                    ec.cancel_wait();
+                }else{
+                    ec.commit_wait(key);
+                }
+            }
+        }
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_TASK_GROUP_H
@@ -0,0 +1,52 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 任务优先级：固定的三条优先级车道（lane），数字越小越优先
+// 取任务时按车道从高到低检查，为了防止低优先级任务被持续的高优先级任务饿死，使用简单的“老化”：
+// 每个取任务者自己计数，每 normal_aging_period 次从普通车道开始检查，每 low_aging_period 次从低优先级车道开始检查，
+// 因此在高优先级任务源源不断时，普通任务至少获得约 1/8、低优先级任务至少获得约 1/64 的执行机会
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_TASK_PRIORITY_H
+#define CPP_CONCURRENCY_IN_ACTION_TASK_PRIORITY_H
+
+enum class task_priority: unsigned{
+    high = 0,
+    normal = 1,
+    low = 2
+};
+
+unsigned const priority_lane_count = 3;
+
+inline unsigned lane_of(task_priority priority){
+    return static_cast<unsigned>(priority);
+}
+
+class priority_aging{
+public:
+    static constexpr unsigned normal_aging_period = 8;
+    static constexpr unsigned low_aging_period = 64;
+
+    // 依次对每条车道调用 f(lane)，直到返回 true；本次应优先检查的车道排在最前，其余按优先级从高到低
+    template<class Function>
+    bool for_each_lane(Function f){
+        ++tick;
+        unsigned const first = tick % low_aging_period == 0 ? lane_of(task_priority::low)
+                               : tick % normal_aging_period == 0 ? lane_of(task_priority::normal)
+                               : lane_of(task_priority::high);
+        if(f(first)){
+            return true;
+        }
+        for(unsigned lane = 0; lane < priority_lane_count; ++lane){
+            if(lane != first && f(lane)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    unsigned tick = 0;
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_TASK_PRIORITY_H
@@ -6,11 +6,25 @@
 #define CPP_CONCURRENCY_IN_ACTION_THREADPOOL_H
 
 #include "work_stealing_queue.h"
-#include "../6.7_threadsafe_queue_final.h"
+#include "event_count.h"
+#include "cpu_topology.h"
+#include "task_priority.h"
+#include "timer_wheel.h"
+#include "pool_queue.h"
 #include <atomic>
 #include <vector>
 #include <future>
 #include <iostream>
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <array>
+#include <cstdint>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 // 利用RAII机制保证所有线程都能join
 class join_threads{
@@ -28,84 +42,533 @@ public:
     }
 };
 
+// 线程池的窃取统计：每次探测一个受害者队列计为一次尝试，探测到任务计为一次成功，
+// tasks_stolen 还包括成功后顺带批量搬到本地队列的任务
+struct thread_pool_stats{
+    std::uint64_t steal_attempts;
+    std::uint64_t steal_successes;
+    std::uint64_t tasks_stolen;
+};
+
 class thread_pool{
 public:
-    thread_pool(): done(false), joiner(threads){
-        size_t const thread_count = std::thread::hardware_concurrency();
+    thread_pool(): thread_pool(0){}
+
+    // thread_count 为 0 时使用 hardware_concurrency 个工作线程
+    // 第 i 个工作线程对应拓扑中按 (节点, 插槽, 物理核) 排序后的第 i % n 个 CPU，因此相邻编号的线程先填满同一个节点；
+    // pin_workers 为 true 时把工作线程绑定到该 CPU，否则只用它决定所属节点与窃取顺序
+    explicit thread_pool(std::size_t thread_count, bool pin_workers_ = false):
+            done(false), topology(cpu_topology::detect()), pin_workers(pin_workers_),
+            timers([this](function_wrapper task, task_priority priority){ post(priority, std::move(task)); }),
+            joiner(threads){
+        if(thread_count == 0){
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
         try{
+            for(unsigned node = 0; node < topology.node_count; ++node){
+                pool_work_queues.push_back(std::unique_ptr<pool_lanes>(new pool_lanes));
+            }
             for(size_t i = 0; i < thread_count; i++){
-                queues.push_back(std::unique_ptr<work_stealing_queue>(new work_stealing_queue));
+                queues.push_back(std::unique_ptr<local_lanes>(new local_lanes));
+                workers.push_back(worker_info{topology.cpus[i % topology.cpus.size()], {}, 0, 0});
             }
+            for(size_t i = 0; i < thread_count; ++i){
+                build_steal_order(static_cast<unsigned>(i));
+            }
+            worker_stats.reset(new steal_counters[thread_count]);
             for(size_t i = 0; i < thread_count; ++i){
                 threads.push_back(std::thread(&thread_pool::work_thread, this, i));
             }
         }catch (...){
             done = true;
+            idle_event.notify_all();    // 已经启动的工作线程可能睡眠在 idle_event 上，唤醒它们退出，否则 joiner 会一直等待
             throw;
         }
     }
 
+    // 在析构函数体内就 join 所有工作线程，此后才开始析构成员，
+    // 因此 idle_event、任务队列等工作线程会访问的成员不会先于线程结束而析构，不依赖它们与 joiner 的声明顺序
     ~thread_pool(){
+        timers.stop();      // 先停止时间轮，之后不会再有到期任务进入队列
         done = true;
+        idle_event.notify_all();    // 唤醒所有睡眠的工作线程，让它们退出
+        for(auto &t: threads){
+            if(t.joinable()){
+                t.join();
+            }
+        }
     }
 
     template<class Function>
     auto submit(Function f) -> std::future<typename std::result_of<Function()>::type>{
+        return submit(task_priority::normal, std::move(f));
+    }
+
+    // 按优先级提交：工作线程总是先检查高优先级车道（包括窃取时），低优先级车道通过老化避免饿死
+    template<class Function>
+    auto submit(task_priority priority, Function f) -> std::future<typename std::result_of<Function()>::type>{
         using result_type = typename std::result_of<Function()>::type;
         std::packaged_task<result_type ()> task(f);
         std::future<result_type> res(task.get_future());
-        if(local_work_queue){
-            std::cout << "push to local queue." << std::endl;
-            local_work_queue->push(std::move(task));
+        if(local_lanes *local = own_local_queues()){
+            (*local)[lane_of(priority)].push(std::move(task));
         }else{
-            std::cout << "push to global queue." << std::endl;
-            pool_work_queue.push(std::move(task));
+            home_pool_queue(priority).push(std::move(task));
         }
+        notify_idle_worker();
         return res;
     }
 
+    // 批量提交：对 [first, last) 中的每个元素调用 f(*it)，返回值被忽略
+    // 整个区间被切成若干块（每个工作线程 chunks_per_thread 块），所有块通过一次队列操作入队，
+    // 并按块数唤醒相应数量的睡眠线程。返回一个整体的完成句柄，任一元素抛出的第一个异常会通过它传出
+    template<class Iterator, class Function>
+    std::future<void> bulk_submit(Iterator first, Iterator last, Function f){
+        return bulk_submit(task_priority::normal, first, last, std::move(f));
+    }
+
+    template<class Iterator, class Function>
+    std::future<void> bulk_submit(task_priority priority, Iterator first, Iterator last, Function f){
+        auto state = std::make_shared<bulk_state>();
+        std::future<void> res = state->done.get_future();
+        std::size_t const length = std::distance(first, last);
+        if(length == 0){
+            state->done.set_value();
+            return res;
+        }
+
+        std::size_t const chunk_count = std::min(length, std::max<std::size_t>(threads.size(), 1) * chunks_per_thread);
+        std::size_t const chunk_size = length / chunk_count;
+        std::size_t const remainder = length % chunk_count;
+        state->remaining.store(chunk_count, std::memory_order_relaxed);
+
+        std::vector<task_type> batch;
+        batch.reserve(chunk_count);
+        Iterator chunk_start = first;
+        for(std::size_t i = 0; i < chunk_count; ++i){
+            Iterator chunk_end = chunk_start;
+            std::advance(chunk_end, chunk_size + (i < remainder ? 1 : 0));
+            batch.emplace_back([state, chunk_start, chunk_end, f]() mutable{
+                try{
+                    for(Iterator it = chunk_start; it != chunk_end; ++it){
+                        f(*it);
+                    }
+                }catch (...){
+                    state->fail(std::current_exception());
+                }
+                state->finish_one();
+            });
+            chunk_start = chunk_end;
+        }
+
+        if(local_lanes *local = own_local_queues()){
+            (*local)[lane_of(priority)].push_batch(batch.begin(), batch.end());
+        }else{
+            home_pool_queue(priority).push_batch(batch.begin(), batch.end());
+        }
+        idle_event.notify_n(static_cast<unsigned>(std::min(chunk_count, threads.size())));
+        return res;
+    }
+
+    // 提交一个不需要返回值的任务，不创建 packaged_task 与 future（供 task_group 等上层组件使用）
+    template<class Function>
+    void post(Function f){
+        post(task_priority::normal, std::move(f));
+    }
+
+    template<class Function>
+    void post(task_priority priority, Function f){
+        if(local_lanes *local = own_local_queues()){
+            (*local)[lane_of(priority)].push(task_type(std::move(f)));
+        }else{
+            home_pool_queue(priority).push(task_type(std::move(f)));
+        }
+        notify_idle_worker();
+    }
+
+    // 延迟任务与周期任务：由时间轮线程在到期时放入普通的任务队列（与 post 相同，不返回 future），工作线程不会为此空转。
+    // 返回的编号可用于 cancel_timer，插入与取消都是 O(1)
+    template<class Rep, class Period, class Function>
+    timer_id submit_after(std::chrono::duration<Rep, Period> delay, Function f, task_priority priority = task_priority::normal){
+        return submit_at(std::chrono::steady_clock::now() + delay, std::move(f), priority);
+    }
+
+    template<class Function>
+    timer_id submit_at(std::chrono::steady_clock::time_point when, Function f, task_priority priority = task_priority::normal){
+        return timers.schedule_at(when, std::move(f), priority);
+    }
+
+    // 第一次在 period 之后执行，此后每隔 period 执行一次；上一次执行结束前不会开始下一次
+    template<class Rep, class Period, class Function>
+    timer_id submit_every(std::chrono::duration<Rep, Period> period, Function f, task_priority priority = task_priority::normal){
+        auto const p = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        return timers.schedule_every(std::chrono::steady_clock::now() + p, p, std::move(f), priority);
+    }
+
+    // 取消尚未到期的延迟任务或周期任务，已经触发（或不存在）时返回 false
+    bool cancel_timer(timer_id id){
+        return timers.cancel(id);
+    }
+
+    std::size_t pending_timers() const{
+        return timers.size();
+    }
+
     void run_pending_task(){
+        if(!try_run_pending_task()){
+            std::this_thread::yield();
+        }
+    }
+
+    // 取出并执行一个任务，没有任务时立即返回 false。由近及远：
+    // 本地队列 -> 本节点的全局队列 -> 窃取同一物理核、同一节点的线程 -> 其它节点的全局队列 -> 窃取其它节点的线程
+    // 前两步与后三步各自按车道从高优先级到低优先级检查（见 priority_aging）
+    bool try_run_pending_task(){
         task_type task;
-        if(pop_task_from_local_queue(task) || pop_task_from_pool_queue(task) || pop_task_from_other_thread_queue(task)){
+        if(find_task(task)){
             task();
-        }else{
-            std::this_thread::yield();
+            return true;
         }
+        return false;
+    }
+
+    // 任务组完成时通知的事件，供在池外线程上阻塞等待的组件（如 task_group）使用。寿命与线程池相同
+    event_count& completion_event(){
+        return group_done_event;
+    }
+
+    // 当前线程是否为本线程池的工作线程（其它线程池的工作线程不算）
+    bool owns_current_thread() const{
+        return owner_pool == this;
+    }
+
+    std::size_t thread_count() const{
+        return threads.size();
+    }
+
+    const cpu_topology& topology_info() const{
+        return topology;
+    }
+
+    // 第 index 个工作线程所在的 CPU 以及它的窃取顺序（工作线程编号），用于调试与展示
+    const cpu_info& worker_cpu(unsigned index) const{
+        return workers[index].cpu;
+    }
+
+    const std::vector<unsigned>& worker_steal_order(unsigned index) const{
+        return workers[index].steal_order;
+    }
+
+    // 所有工作线程的窃取统计之和（各计数器独立读取，不是一致的快照）
+    thread_pool_stats stats() const{
+        thread_pool_stats res{0, 0, 0};
+        for(std::size_t i = 0; i < threads.size(); ++i){
+            res.steal_attempts += worker_stats[i].steal_attempts.load(std::memory_order_relaxed);
+            res.steal_successes += worker_stats[i].steal_successes.load(std::memory_order_relaxed);
+            res.tasks_stolen += worker_stats[i].tasks_stolen.load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+    static void cpu_relax(){
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
     }
 
 private:
     using task_type = function_wrapper;
+
+    // 每个工作线程的位置与窃取顺序：steal_order 依次为同一物理核、同一节点、其它节点的线程，
+    // 前 sibling_count 个在同一物理核上，前 near_count 个属于本节点。每一层内部的起点在窃取时随机选择
+    struct worker_info{
+        cpu_info cpu;
+        std::vector<unsigned> steal_order;
+        std::size_t sibling_count;
+        std::size_t near_count;
+    };
+
+    // 只由对应的工作线程写入，单独占一个缓存行，避免统计本身造成伪共享
+    struct alignas(64) steal_counters{
+        std::atomic<std::uint64_t> steal_attempts{0};
+        std::atomic<std::uint64_t> steal_successes{0};
+        std::atomic<std::uint64_t> tasks_stolen{0};
+
+        static void add(std::atomic<std::uint64_t> &counter, std::uint64_t n){
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
     std::atomic<bool> done;
-    threadsafe_queue<task_type> pool_work_queue;
-    std::vector<std::unique_ptr<work_stealing_queue>> queues;
+    event_count idle_event;     // 在 joiner 之前声明：构造函数抛出异常时，joiner 先 join 已启动的工作线程，之后它才析构
+    event_count group_done_event;
+    std::atomic<unsigned> searching_workers{0};     // 正在自旋寻找任务（尚未睡眠）的工作线程数
+    cpu_topology topology;
+    bool pin_workers;
+    // 每条优先级车道一个队列
+    using local_lanes = std::array<work_stealing_queue, priority_lane_count>;
+    using pool_lanes = std::array<pool_queue<task_type>, priority_lane_count>;
+    std::vector<std::unique_ptr<pool_lanes>> pool_work_queues;      // 每个 NUMA 节点一组
+    std::vector<worker_info> workers;
+    std::unique_ptr<steal_counters[]> worker_stats;
+    std::vector<std::unique_ptr<local_lanes>> queues;
+    timer_wheel timers;     // 派发时会访问任务队列，必须在它们之后构造；在工作线程全部 join 之后才析构
     std::vector<std::thread> threads;
     join_threads joiner;
 
-    static thread_local work_stealing_queue *local_work_queue;
+    // bulk_submit 的共享状态：剩余块数计数 + 整体完成句柄，每批只分配一次
+    struct bulk_state{
+        std::atomic<std::size_t> remaining{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::promise<void> done;
+
+        void fail(std::exception_ptr e){
+            if(!failed.exchange(true)){
+                error = e;
+            }
+        }
+
+        void finish_one(){
+            if(remaining.fetch_sub(1, std::memory_order_acq_rel) == 1){
+                if(error){
+                    done.set_exception(error);
+                }else{
+                    done.set_value();
+                }
+            }
+        }
+    };
+    static constexpr std::size_t chunks_per_thread = 4;
+
+    // 工作线程的线程局部状态。local_work_queues 与 thread_index 只对 owner_pool 有意义：
+    // 一个线程池的工作线程向另一个线程池提交任务或执行其任务时，按池外线程处理（见 own_local_queues）
+    static thread_local thread_pool *owner_pool;
+    static thread_local local_lanes *local_work_queues;
+    static thread_local priority_aging aging;
     static thread_local unsigned thread_index;
+    static thread_local std::uint64_t random_state;
+
+    // 只唤醒一个睡眠的工作线程；已有线程在自旋寻找任务时它会找到新任务，不必再唤醒（没有线程睡眠时几乎没有开销）
+    // 与 work_thread 中停止寻找后的栅栏配对：要么通知方看到寻找者数量为 0，要么寻找者在睡眠前看到新任务
+    void notify_idle_worker(){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(searching_workers.load(std::memory_order_relaxed) == 0){
+            idle_event.notify_one();
+        }
+    }
+
+    // 先按车道检查自己的本地队列与本节点的全局队列，都没有任务时再按车道窃取。
+    // 若把窃取也放进同一轮，持有任务的线程每次取任务前都要先探测所有线程的高优先级车道
+    bool find_task(task_type &task){
+        return aging.for_each_lane([&](unsigned lane){
+            return pop_task_from_local_queue(task, lane) || pop_task_from_pool_queue(task, lane);
+        }) || aging.for_each_lane([&](unsigned lane){
+            return pop_task_from_other_thread_queue(task, lane, false) || pop_task_from_remote_pool_queue(task, lane)
+                   || pop_task_from_other_thread_queue(task, lane, true);
+        });
+    }
+
+    // 空闲策略：先自旋 spin_rounds 轮，每轮窃取失败后的 pause 次数从 1 开始翻倍，直到 max_backoff；
+    // 再让出时间片 yield_rounds 次，仍然没有任务就睡眠，直到 submit 唤醒。
+    // 退避减少了空闲线程探测其它队列的频率，队列的 top/bottom 所在缓存行不会被空闲线程反复读走
+    static constexpr unsigned spin_rounds = 16;
+    static constexpr unsigned max_backoff = 256;
+    static constexpr unsigned yield_rounds = 16;
+
+    // xorshift64，每个线程一份状态，用来随机选择窃取的起点
+    static std::uint64_t next_random(){
+        std::uint64_t x = random_state;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return random_state = x;
+    }
+
+    void build_steal_order(unsigned index){
+        worker_info &self = workers[index];
+        std::vector<unsigned> siblings, same_node, remote;
+        for(unsigned i = 1; i < workers.size(); ++i){
+            unsigned const other = (index + i) % workers.size();
+            cpu_info const &cpu = workers[other].cpu;
+            if(cpu.core == self.cpu.core){
+                siblings.push_back(other);
+            }else if(cpu.node == self.cpu.node){
+                same_node.push_back(other);
+            }else{
+                remote.push_back(other);
+            }
+        }
+        self.steal_order = siblings;
+        self.sibling_count = self.steal_order.size();
+        self.steal_order.insert(self.steal_order.end(), same_node.begin(), same_node.end());
+        self.near_count = self.steal_order.size();
+        self.steal_order.insert(self.steal_order.end(), remote.begin(), remote.end());
+    }
+
+    // 当前线程是本线程池的工作线程时返回它的本地队列，否则返回 nullptr
+    local_lanes* own_local_queues() const{
+        return owner_pool == this ? local_work_queues : nullptr;
+    }
+
+    // 工作线程使用自己所在节点的全局队列；池外线程使用它当前运行的 CPU 所在节点的队列
+    unsigned home_node() const{
+        return own_local_queues() ? workers[thread_index].cpu.node : topology.current_node();
+    }
+
+    pool_queue<task_type>& home_pool_queue(task_priority priority){
+        return (*pool_work_queues[home_node()])[lane_of(priority)];
+    }
 
     void work_thread(unsigned index){
+        owner_pool = this;
         thread_index = index;
-        local_work_queue = queues[thread_index].get();
+        local_work_queues = queues[thread_index].get();
+        random_state = 0x9e3779b97f4a7c15ull * (index + 1);
+        if(pin_workers){
+            cpu_topology::pin_current_thread(workers[index].cpu.cpu);
+        }
+        unsigned idle_rounds = 0;
+        unsigned backoff = 1;
+        bool searching = false;
         while(!done){
-            run_pending_task();
+            task_type task;
+            if(find_task(task)){
+                // 最后一个寻找者找到任务后，可能还有别的任务没人领取，再唤醒一个线程接替寻找
+                if(searching){
+                    searching = false;
+                    if(searching_workers.fetch_sub(1, std::memory_order_seq_cst) == 1){
+                        idle_event.notify_one();
+                    }
+                }
+                task();
+                idle_rounds = 0;
+                backoff = 1;
+                continue;
+            }
+            if(!searching){
+                searching = true;
+                searching_workers.fetch_add(1, std::memory_order_seq_cst);
+            }
+            if(idle_rounds < spin_rounds){
+                ++idle_rounds;
+                for(unsigned i = 0; i < backoff; ++i){
+                    cpu_relax();
+                }
+                backoff = std::min(backoff * 2, max_backoff);
+            }else if(idle_rounds < spin_rounds + yield_rounds){
+                ++idle_rounds;
+                std::this_thread::yield();
+            }else{
+                searching = false;
+                searching_workers.fetch_sub(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wait_for_task();
+                // 被唤醒的线程立即算作寻找者：它找到任务后若是最后一个寻找者，会再唤醒下一个线程，
+                // 一批连续提交的任务（提交方看到有寻找者就不再唤醒）因此能逐个传递唤醒，分散到多个线程
+                searching = true;
+                searching_workers.fetch_add(1, std::memory_order_seq_cst);
+                idle_rounds = 0;
+                backoff = 1;
+            }
+        }
+        if(searching){
+            searching_workers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 登记为等待者后再检查一次队列，避免在检查与睡眠之间错过 submit 的唤醒
+    void wait_for_task(){
+        auto const key = idle_event.prepare_wait();
+        if(done || has_pending_task()){
+            idle_event.cancel_wait();
+            return;
+        }
+        idle_event.commit_wait(key);
+    }
+
+    bool has_pending_task(){
+        for(auto &lanes: pool_work_queues){
+            for(auto &q: *lanes){
+                if(!q.empty()){
+                    return true;
+                }
+            }
+        }
+        for(auto &lanes: queues){
+            for(auto &q: *lanes){
+                if(!q.empty()){
+                    return true;
+                }
+            }
         }
+        return false;
+    }
+
+    bool pop_task_from_local_queue(task_type &task, unsigned lane){
+        local_lanes *local = own_local_queues();
+        return local && (*local)[lane].try_pop(task);
     }
 
-    bool pop_task_from_local_queue(task_type &task){
-        return local_work_queue && local_work_queue->try_pop(task);
+    bool pop_task_from_pool_queue(task_type &task, unsigned lane){
+        return (*pool_work_queues[home_node()])[lane].try_pop(task);
     }
 
-    bool pop_task_from_pool_queue(task_type &task){
-        return pool_work_queue.try_pop(task);
+    bool pop_task_from_remote_pool_queue(task_type &task, unsigned lane){
+        unsigned const home = home_node();
+        for(unsigned i = 1; i < pool_work_queues.size(); ++i){
+            if((*pool_work_queues[(home + i) % pool_work_queues.size()])[lane].try_pop(task)){
+                return true;
+            }
+        }
+        return false;
     }
 
-    // 尝试从其它线程中窃取任务
-    // 接着上次访问的任务队列继续访问，防止前几个线程频遭窃取
-    bool pop_task_from_other_thread_queue(task_type &task){
-        for(unsigned i = 0; i < queues.size(); ++i){
-            unsigned const index = (thread_index + i + 1) % queues.size();
-            if(queues[index]->try_steal(task)){
+    // 尝试从其它线程的 lane 车道中窃取任务：remote 为 false 时依次窃取同一物理核、同一节点的线程，为 true 时只窃取其它节点的线程
+    // 池外线程没有窃取顺序，只在第一轮里按编号依次访问所有线程
+    bool pop_task_from_other_thread_queue(task_type &task, unsigned lane, bool remote){
+        if(!own_local_queues()){
+            if(remote){
+                return false;
+            }
+            for(auto &lanes: queues){
+                if((*lanes)[lane].try_steal(task)){
+                    return true;
+                }
+            }
+            return false;
+        }
+        worker_info const &self = workers[thread_index];
+        if(remote){
+            return steal_from(task, lane, self.near_count, self.steal_order.size());
+        }
+        return steal_from(task, lane, 0, self.sibling_count) || steal_from(task, lane, self.sibling_count, self.near_count);
+    }
+
+    // 在 steal_order[first, last) 中从随机位置开始依次探测，避免所有空闲线程按同一顺序挤向同一个队列。
+    // 窃取成功后再从同一个受害者那里搬走约一半剩余任务放进本地队列，减少之后的窃取次数
+    bool steal_from(task_type &task, unsigned lane, std::size_t first, std::size_t last){
+        std::size_t const count = last - first;
+        if(count == 0){
+            return false;
+        }
+        worker_info const &self = workers[thread_index];
+        steal_counters &counters = worker_stats[thread_index];
+        std::size_t const start = next_random() % count;
+        for(std::size_t i = 0; i < count; ++i){
+            work_stealing_queue &victim = (*queues[self.steal_order[first + (start + i) % count]])[lane];
+            steal_counters::add(counters.steal_attempts, 1);
+            if(victim.try_steal(task)){
+                std::size_t moved = 0;
+                for(std::size_t extra = victim.size() / 2; moved < extra; ++moved){
+                    task_type t;
+                    if(!victim.try_steal(t)){
+                        break;
+                    }
+                    (*local_work_queues)[lane].push(std::move(t));
+                }
+                steal_counters::add(counters.steal_successes, 1);
+                steal_counters::add(counters.tasks_stolen, moved + 1);
                 return true;
             }
         }
@@ -113,8 +576,11 @@ private:
     }
 };
 
-thread_local work_stealing_queue* thread_pool::local_work_queue = nullptr;
+thread_local thread_pool* thread_pool::owner_pool = nullptr;
+thread_local thread_pool::local_lanes* thread_pool::local_work_queues = nullptr;
+thread_local priority_aging thread_pool::aging;
 thread_local unsigned thread_pool::thread_index = 0;
+thread_local std::uint64_t thread_pool::random_state = 0x9e3779b97f4a7c15ull;
 
 #endif //CPP_CONCURRENCY_IN_ACTION_THREADPOOL_H
 
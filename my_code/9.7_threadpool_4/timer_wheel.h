@@ -0,0 +1,387 @@
+//
+// Created by chen on 2026/10/18.
+//
+
+// 分层时间轮（hierarchical timing wheel）：延迟任务、定时任务与周期任务
+// - 时间被划分为固定长度的 tick（默认 1ms）。共 level_count 层，每层 64 个槽：
+//   第0层的槽对应接下来 64 个 tick，第1层的槽对应接下来 64*64 个 tick 中的每一段 64 tick，依此类推
+// - 插入：根据到期时间与当前 tick 的差值直接算出层号与槽号，挂到槽的双向链表上，O(1)
+// - 取消：定时器编号中带有节点下标与代数（generation），直接从链表上摘除，O(1)；节点被复用后旧编号自动失效
+// - 推进：第0层每转完一圈，把上一层的当前槽整体“下沉”（按剩余时间重新插入），
+//   每个定时器最多下沉 level_count-1 次；超出总范围的定时器先放在最高层，下沉时再重新计算
+// - 一个后台线程睡眠到下一个非空槽（或下一次下沉）的时刻，不会空转；到期的任务交给 dispatch 回调，
+//   由线程池放入普通的任务队列执行，时间轮线程本身从不执行用户任务
+// 节点分块分配（每块 4096 个），扩容不会搬动已有节点，百万级定时器也不会在持有锁时出现长时间的拷贝
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_TIMER_WHEEL_H
+#define CPP_CONCURRENCY_IN_ACTION_TIMER_WHEEL_H
+
+#include "function_wrapper.h"
+#include "task_priority.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 0 不是合法的定时器编号
+using timer_id = std::uint64_t;
+
+class timer_wheel{
+public:
+    using clock = std::chrono::steady_clock;
+    using dispatch_function = std::function<void(function_wrapper, task_priority)>;
+
+    explicit timer_wheel(dispatch_function dispatch_, clock::duration tick_ = std::chrono::milliseconds(1)):
+            dispatch(std::move(dispatch_)), tick(tick_), start(clock::now()), now_tick(0), wake_tick(no_tick),
+            timer_count(0), free_head(npos), stopping(false){
+        for(auto &level: wheel){
+            std::fill(std::begin(level.heads), std::end(level.heads), npos);
+        }
+    }
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    ~timer_wheel(){
+        stop();
+    }
+
+    // 停止后台线程；尚未到期的定时器不再执行
+    void stop(){
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        if(worker.joinable()){
+            worker.join();
+        }
+    }
+
+    // 在 when 时刻（之后的第一个 tick）把 f 交给 dispatch
+    template<class Function>
+    timer_id schedule_at(clock::time_point when, Function f, task_priority priority = task_priority::normal){
+        std::lock_guard<std::mutex> lock(m);
+        std::uint32_t const index = allocate();
+        timer_node &n = node(index);
+        n.task = function_wrapper(std::move(f));
+        n.period = 0;
+        n.priority = priority;
+        return arm(index, tick_of(when));
+    }
+
+    // 从 first 开始每隔 period 执行一次 f，直到被取消。
+    // 下一次在本次执行结束后才重新挂上时间轮，因此同一个周期任务不会并发执行；落后时跳过错过的周期，不会补跑
+    template<class Function>
+    timer_id schedule_every(clock::time_point first, clock::duration period, Function f,
+                            task_priority priority = task_priority::normal){
+        std::lock_guard<std::mutex> lock(m);
+        std::uint32_t const index = allocate();
+        timer_node &n = node(index);
+        n.periodic = std::make_shared<function_wrapper>(std::move(f));
+        n.period = std::max<std::uint64_t>(1, (period + tick - clock::duration(1)) / tick);
+        n.priority = priority;
+        return arm(index, tick_of(first));
+    }
+
+    // 取消尚未到期的定时器；周期任务正在执行时取消，则本次执行结束后不再重新挂上。定时器已经触发或不存在时返回 false
+    bool cancel(timer_id id){
+        std::lock_guard<std::mutex> lock(m);
+        std::uint32_t const index = index_of(id);
+        if(index >= capacity || node(index).generation != generation_of(id) || node(index).state == timer_state::free){
+            return false;
+        }
+        timer_node &n = node(index);
+        if(n.state == timer_state::armed){
+            unlink(index);
+        }
+        release(index);
+        return true;
+    }
+
+    // 尚未到期（不含正在执行的周期任务）的定时器个数
+    std::size_t size() const{
+        std::lock_guard<std::mutex> lock(m);
+        return timer_count;
+    }
+
+private:
+    static constexpr unsigned slot_bits = 6;
+    static constexpr unsigned slot_count = 1u << slot_bits;
+    static constexpr std::uint64_t slot_mask = slot_count - 1;
+    static constexpr unsigned level_count = 5;      // 1ms 的 tick 下可以直接表示约 12 天
+    static constexpr std::uint64_t max_delta = std::uint64_t(1) << (slot_bits * level_count);
+    static constexpr std::uint32_t npos = ~std::uint32_t(0);
+    static constexpr std::uint64_t no_tick = ~std::uint64_t(0);
+    static constexpr unsigned chunk_bits = 12;
+
+    enum class timer_state: unsigned char{
+        free,
+        armed,      // 挂在某个槽上
+        running     // 周期任务已经交出、正在等待重新挂上
+    };
+
+    struct timer_node{
+        function_wrapper task;                          // 一次性任务
+        std::shared_ptr<function_wrapper> periodic;     // 周期任务（派发出去的任务与节点共享）
+        std::uint64_t expiry = 0;                       // 到期的 tick
+        std::uint64_t period = 0;                       // 周期（tick），0 表示一次性任务
+        std::uint32_t prev = npos, next = npos;         // 槽内双向链表；空闲节点用 next 串成空闲链表
+        std::uint32_t generation = 1;
+        timer_state state = timer_state::free;
+        task_priority priority = task_priority::normal;
+        unsigned char level = 0, slot = 0;              // 所在的槽，摘除链表头时使用
+    };
+
+    struct wheel_level{
+        std::uint32_t heads[slot_count];
+        std::uint64_t occupied = 0;     // 非空槽的位图，用于快速找到下一个需要处理的槽
+    };
+
+    dispatch_function dispatch;
+    clock::duration const tick;
+    clock::time_point const start;
+    std::uint64_t now_tick;     // 下一个要处理的 tick，之前的 tick 都已处理完毕
+    std::uint64_t wake_tick;    // 后台线程计划醒来的 tick
+    wheel_level wheel[level_count];
+    std::vector<std::unique_ptr<timer_node[]>> chunks;
+    std::uint32_t capacity = 0;
+    std::size_t timer_count;
+    std::uint32_t free_head;
+    std::vector<std::pair<function_wrapper, task_priority>> expired;
+    bool stopping;
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::thread worker;
+
+    static std::uint32_t index_of(timer_id id){
+        return static_cast<std::uint32_t>(id);
+    }
+
+    static std::uint32_t generation_of(timer_id id){
+        return static_cast<std::uint32_t>(id >> 32);
+    }
+
+    timer_node& node(std::uint32_t index){
+        return chunks[index >> chunk_bits][index & ((1u << chunk_bits) - 1)];
+    }
+
+    // 到达 when 之后的第一个 tick（向上取整，保证不会提前触发）
+    std::uint64_t tick_of(clock::time_point when) const{
+        if(when <= start){
+            return 0;
+        }
+        return static_cast<std::uint64_t>((when - start + tick - clock::duration(1)) / tick);
+    }
+
+    clock::time_point time_of(std::uint64_t t) const{
+        return start + tick * static_cast<clock::rep>(t);
+    }
+
+    std::uint32_t allocate(){
+        if(free_head == npos){
+            chunks.emplace_back(new timer_node[std::size_t(1) << chunk_bits]);
+            std::uint32_t const first = capacity;
+            capacity += 1u << chunk_bits;
+            for(std::uint32_t i = capacity; i-- > first;){
+                node(i).next = free_head;
+                free_head = i;
+            }
+        }
+        std::uint32_t const index = free_head;
+        free_head = node(index).next;
+        return index;
+    }
+
+    // 释放节点：代数加一，使旧的定时器编号全部失效
+    void release(std::uint32_t index){
+        timer_node &n = node(index);
+        n.task = function_wrapper();
+        n.periodic.reset();
+        n.state = timer_state::free;
+        if(++n.generation == 0){
+            n.generation = 1;
+        }
+        n.next = free_head;
+        free_head = index;
+    }
+
+    // 需要持有锁
+    timer_id arm(std::uint32_t index, std::uint64_t expiry){
+        timer_node &n = node(index);
+        n.expiry = std::max(expiry, now_tick);
+        link(index);
+        if(!worker.joinable()){
+            worker = std::thread(&timer_wheel::run, this);
+        }
+        if(n.expiry < wake_tick){
+            wake_tick = n.expiry;
+            cv.notify_one();
+        }
+        return (timer_id(n.generation) << 32) | index;
+    }
+
+    // 按剩余时间选择层与槽
+    void link(std::uint32_t index){
+        timer_node &n = node(index);
+        std::uint64_t const delta = std::min(n.expiry - now_tick, max_delta - 1);
+        std::uint64_t const slot_tick = now_tick + delta;
+        unsigned level = 0;
+        while(level + 1 < level_count && delta >= (std::uint64_t(1) << (slot_bits * (level + 1)))){
+            ++level;
+        }
+        unsigned const slot = static_cast<unsigned>((slot_tick >> (slot_bits * level)) & slot_mask);
+        wheel_level &w = wheel[level];
+        n.prev = npos;
+        n.next = w.heads[slot];
+        if(n.next != npos){
+            node(n.next).prev = index;
+        }
+        w.heads[slot] = index;
+        w.occupied |= std::uint64_t(1) << slot;
+        n.level = static_cast<unsigned char>(level);
+        n.slot = static_cast<unsigned char>(slot);
+        n.state = timer_state::armed;
+        ++timer_count;
+    }
+
+    void unlink(std::uint32_t index){
+        timer_node &n = node(index);
+        if(n.prev != npos){
+            node(n.prev).next = n.next;
+        }else{
+            wheel_level &w = wheel[n.level];
+            w.heads[n.slot] = n.next;
+            if(n.next == npos){
+                w.occupied &= ~(std::uint64_t(1) << n.slot);
+            }
+        }
+        if(n.next != npos){
+            node(n.next).prev = n.prev;
+        }
+        n.prev = n.next = npos;
+        --timer_count;
+    }
+
+    // 摘下整个槽，返回链表头
+    std::uint32_t take_slot(unsigned level, unsigned slot){
+        wheel_level &w = wheel[level];
+        std::uint32_t const head = w.heads[slot];
+        w.heads[slot] = npos;
+        w.occupied &= ~(std::uint64_t(1) << slot);
+        return head;
+    }
+
+    // 处理 now_tick 这一个 tick：先从高层下沉，再把第0层当前槽中的定时器全部取出
+    void process_tick(){
+        for(unsigned level = 1; level < level_count; ++level){
+            if((now_tick & ((std::uint64_t(1) << (slot_bits * level)) - 1)) != 0){
+                break;
+            }
+            unsigned const slot = static_cast<unsigned>((now_tick >> (slot_bits * level)) & slot_mask);
+            for(std::uint32_t i = take_slot(level, slot); i != npos;){
+                std::uint32_t const next = node(i).next;
+                --timer_count;
+                link(i);
+                i = next;
+            }
+        }
+        for(std::uint32_t i = take_slot(0, static_cast<unsigned>(now_tick & slot_mask)); i != npos;){
+            timer_node &n = node(i);
+            std::uint32_t const next = n.next;
+            --timer_count;
+            if(n.periodic){
+                n.state = timer_state::running;
+                timer_id const id = (timer_id(n.generation) << 32) | i;
+                expired.emplace_back([this, id, task = n.periodic]{
+                    (*task)();
+                    rearm(id);
+                }, n.priority);
+            }else{
+                expired.emplace_back(std::move(n.task), n.priority);
+                release(i);
+            }
+            i = next;
+        }
+        ++now_tick;
+    }
+
+    // 周期任务执行完毕后重新挂上时间轮（期间被取消则什么也不做）
+    void rearm(timer_id id){
+        std::lock_guard<std::mutex> lock(m);
+        std::uint32_t const index = index_of(id);
+        if(stopping || node(index).generation != generation_of(id) || node(index).state != timer_state::running){
+            return;
+        }
+        timer_node &n = node(index);
+        std::uint64_t expiry = n.expiry + n.period;
+        if(expiry < now_tick){
+            expiry += (now_tick - expiry + n.period - 1) / n.period * n.period;
+        }
+        arm(index, expiry);
+    }
+
+    // 下一个需要处理的 tick：第0层本圈内的下一个非空槽，或者下一次下沉（now_tick 恰好在一圈的开头时就是它自己）
+    std::uint64_t next_event_tick() const{
+        if(timer_count == 0){
+            return no_tick;
+        }
+        if((now_tick & slot_mask) == 0){
+            return now_tick;
+        }
+        unsigned const current = static_cast<unsigned>(now_tick & slot_mask);
+        std::uint64_t const ahead = wheel[0].occupied >> current;   // 本圈剩余的槽
+        if(ahead != 0){
+            return now_tick + static_cast<unsigned>(std::countr_zero(ahead));
+        }
+        return (now_tick | slot_mask) + 1;
+    }
+
+    void run(){
+        std::unique_lock<std::mutex> lock(m);
+        while(!stopping){
+            std::uint64_t const due = tick_of(clock::now() + clock::duration(1)) - 1;   // 时刻已到的最后一个 tick
+            while(now_tick <= due && timer_count != 0){
+                std::uint64_t const next = next_event_tick();
+                if(next > due){
+                    // 直到 due 都没有需要处理的槽，可以直接跳过（不能越过下一次下沉）
+                    now_tick = due + 1;
+                    break;
+                }
+                now_tick = next;
+                process_tick();
+            }
+            if(timer_count == 0 && now_tick <= due){
+                now_tick = due + 1;     // 没有定时器时直接跳过
+            }
+            if(!expired.empty()){
+                std::vector<std::pair<function_wrapper, task_priority>> ready;
+                ready.swap(expired);
+                lock.unlock();
+                for(auto &[task, priority]: ready){
+                    dispatch(std::move(task), priority);
+                }
+                ready.clear();
+                lock.lock();
+                if(expired.empty()){
+                    expired.swap(ready);    // 重复使用已分配的空间
+                }
+                continue;
+            }
+            wake_tick = next_event_tick();
+            if(wake_tick == no_tick){
+                cv.wait(lock);
+            }else{
+                cv.wait_until(lock, time_of(wake_tick));
+            }
+            wake_tick = no_tick;
+        }
+    }
+};
+
+#endif //CPP_CONCURRENCY_IN_ACTION_TIMER_WHEEL_H
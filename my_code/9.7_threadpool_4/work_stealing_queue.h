@@ -2,53 +2,217 @@
 // Created by chen on 2022/9/5.
 //
 
-// 基于deque双端队列的线程安全任务窃取队列
-// 具体而言，持有该队列的线程从队头领取任务，其它线程则从队尾领取任务
-// 这里为了简化实现，只采用了粗粒度的锁
+// 无锁的任务窃取队列（Chase-Lev 双端队列）
+// 持有该队列的线程在 bottom 端 push / try_pop（后进先出），其它线程在 top 端 try_steal（先进先出）
+// - 本地线程的 push / try_pop 快速路径上没有原子读-改-写操作，只有在队列仅剩最后一个任务时才需要CAS
+// - 窃取线程只需要对 top 做一次CAS
+// - 底层是可增长的环形数组，槽位中存放任务节点的指针，窃取线程读到的指针即使“过期”，CAS失败后也会被丢弃
+// - 任务节点来自队列自己的节点池，预热之后 push 不再分配堆内存（见 acquire_node / release_node）
+// 参考：Chase & Lev, "Dynamic Circular Work-Stealing Deque", SPAA 2005；
+//      Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013
 
 #ifndef CPP_CONCURRENCY_IN_ACTION_WORK_STEALING_QUEUE_H
 #define CPP_CONCURRENCY_IN_ACTION_WORK_STEALING_QUEUE_H
 
-#include <deque>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
 #include "function_wrapper.h"
 
 class work_stealing_queue{
 private:
     using data_type = function_wrapper;
-    std::deque<data_type> task_queue;
-    mutable std::mutex mtx;
+
+    // 任务节点。槽位不能直接存放 function_wrapper：窃取线程必须先读出任务再用CAS确认，
+    // 而移动任务会改写槽位，CAS失败时无法撤销。因此槽位中仍是指针，但节点在队列内部循环使用
+    struct node{
+        data_type task;
+        node *next = nullptr;
+    };
+    static constexpr std::size_t node_block_size = 64;
+
+    // 环形数组，容量为2的幂。扩容时拷贝 [top, bottom) 区间的指针到新数组
+    struct circular_array{
+        std::int64_t const capacity;
+        std::int64_t const mask;
+        std::unique_ptr<std::atomic<node*>[]> slots;
+
+        explicit circular_array(std::int64_t capacity_):
+            capacity(capacity_), mask(capacity_ - 1), slots(new std::atomic<node*>[capacity_]){}
+
+        node* get(std::int64_t i) const{
+            return slots[i & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, node *p){
+            slots[i & mask].store(p, std::memory_order_relaxed);
+        }
+
+        circular_array* grow(std::int64_t bottom, std::int64_t top) const{
+            circular_array *a = new circular_array(capacity * 2);
+            for(std::int64_t i = top; i != bottom; ++i){
+                a->put(i, get(i));
+            }
+            return a;
+        }
+    };
+
+    // top 与 bottom 分别被窃取线程与本地线程频繁修改，放在不同的缓存行中避免伪共享
+    alignas(64) std::atomic<std::int64_t> top;
+    alignas(64) std::atomic<std::int64_t> bottom;
+    alignas(64) std::atomic<circular_array*> array;
+
+    // 扩容后旧数组可能仍被窃取线程读取，因此延迟到队列析构时才释放。只有本地线程会修改该列表
+    std::vector<std::unique_ptr<circular_array>> retired;
+
+    // 节点池：free_nodes 只由本地线程访问；窃取线程用完的节点挂到 returned_nodes 上（多个线程只做入栈），
+    // 本地线程在 free_nodes 用完时一次性整体取走，不存在 ABA 问题。
+    // 节点按块分配，直到队列析构才释放，池的大小等于队列中曾经同时存在的任务数的峰值
+    node *free_nodes = nullptr;
+    alignas(64) std::atomic<node*> returned_nodes{nullptr};
+    std::vector<std::unique_ptr<node[]>> node_blocks;
+
+    // 只能由持有该队列的线程调用
+    node* acquire_node(){
+        if(!free_nodes){
+            free_nodes = returned_nodes.exchange(nullptr, std::memory_order_acquire);
+        }
+        if(!free_nodes){
+            node *block = new node[node_block_size];
+            node_blocks.emplace_back(block);
+            for(std::size_t i = 0; i + 1 < node_block_size; ++i){
+                block[i].next = &block[i + 1];
+            }
+            free_nodes = block;
+        }
+        node *p = free_nodes;
+        free_nodes = p->next;
+        return p;
+    }
+
+    // 取走任务后归还节点：本地线程直接放回 free_nodes，窃取线程入栈到 returned_nodes
+    void release_node(node *p, bool owner){
+        if(owner){
+            p->next = free_nodes;
+            free_nodes = p;
+            return;
+        }
+        node *head = returned_nodes.load(std::memory_order_relaxed);
+        do{
+            p->next = head;
+        }while(!returned_nodes.compare_exchange_weak(head, p, std::memory_order_release, std::memory_order_relaxed));
+    }
+
 public:
-    work_stealing_queue(){}
+    // initial_capacity 必须是2的幂
+    explicit work_stealing_queue(std::int64_t initial_capacity = 256):
+        top(0), bottom(0), array(new circular_array(initial_capacity)){}
     work_stealing_queue(const work_stealing_queue &other) = delete;
     work_stealing_queue& operator=(const work_stealing_queue &other) = delete;
 
+    // 队列中剩余的任务随 node_blocks 一起析构
+    ~work_stealing_queue(){
+        delete array.load(std::memory_order_relaxed);
+    }
+
+    // 只能由持有该队列的线程调用
     void push(data_type data){
-        std::lock_guard<std::mutex> lock(mtx);
-        task_queue.push_front(std::move(data));
+        std::int64_t const b = bottom.load(std::memory_order_relaxed);
+        std::int64_t const t = top.load(std::memory_order_acquire);
+        circular_array *a = array.load(std::memory_order_relaxed);
+        if(b - t > a->capacity - 1){    // 队列已满，扩容
+            retired.emplace_back(a);
+            a = a->grow(b, t);
+            array.store(a, std::memory_order_release);
+        }
+        node *p = acquire_node();
+        p->task = std::move(data);
+        a->put(b, p);
+        bottom.store(b + 1, std::memory_order_release);     // 保证窃取线程看到新的 bottom 时，槽位已经写好
+    }
+
+    // 只能由持有该队列的线程调用。批量入队：一次性写好所有槽位，最后只发布一次 bottom
+    template<class Iterator>
+    void push_batch(Iterator first, Iterator last){
+        std::int64_t const n = std::distance(first, last);
+        std::int64_t const b = bottom.load(std::memory_order_relaxed);
+        std::int64_t const t = top.load(std::memory_order_acquire);
+        circular_array *a = array.load(std::memory_order_relaxed);
+        if(b - t + n > a->capacity){
+            retired.emplace_back(a);
+            std::int64_t capacity = a->capacity;
+            while(b - t + n > capacity){
+                capacity *= 2;
+            }
+            circular_array *grown = new circular_array(capacity);
+            for(std::int64_t i = t; i != b; ++i){
+                grown->put(i, a->get(i));
+            }
+            a = grown;
+            array.store(a, std::memory_order_release);
+        }
+        for(std::int64_t i = b; first != last; ++first, ++i){
+            node *p = acquire_node();
+            p->task = std::move(*first);
+            a->put(i, p);
+        }
+        bottom.store(b + n, std::memory_order_release);
+    }
+
+    // 近似的任务数，只用于估计（例如决定一次窃取多少任务）
+    std::size_t size() const{
+        std::int64_t const b = bottom.load(std::memory_order_relaxed);
+        std::int64_t const t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
     }
 
     bool empty() const{
-        std::lock_guard<std::mutex> lock(mtx);
-        return task_queue.empty();
+        std::int64_t const b = bottom.load(std::memory_order_relaxed);
+        std::int64_t const t = top.load(std::memory_order_relaxed);
+        return b <= t;
     }
 
+    // 只能由持有该队列的线程调用。本地线程从 bottom 端领取任务
     bool try_pop(data_type &res){
-        std::lock_guard<std::mutex> lock(mtx);
-        if(task_queue.empty()){
+        std::int64_t const b = bottom.load(std::memory_order_relaxed) - 1;
+        circular_array *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);     // 先“预定”最后一个任务
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+        if(t > b){      // 队列为空，恢复 bottom
+            bottom.store(b + 1, std::memory_order_relaxed);
             return false;
         }
-        res = std::move(task_queue.front());    // 本地线程从队头领取任务
-        task_queue.pop_front();
+        node *p = a->get(b);
+        if(t == b){     // 只剩最后一个任务，需要与窃取线程竞争
+            bool const won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if(!won){
+                return false;
+            }
+        }
+        res = std::move(p->task);
+        release_node(p, true);
         return true;
     }
 
+    // 其它线程从 top 端窃取任务
     bool try_steal(data_type &res){
-        std::lock_guard<std::mutex> lock(mtx);
-        if(task_queue.empty()){
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t const b = bottom.load(std::memory_order_acquire);
+        if(t >= b){
             return false;
         }
-        res = std::move(task_queue.back());    // 本地线程从队头领取任务
-        task_queue.pop_back();
+        circular_array *a = array.load(std::memory_order_acquire);
+        node *p = a->get(t);
+        if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+            return false;   // 被其它线程抢先，读到的指针作废
+        }
+        res = std::move(p->task);
+        release_node(p, false);
         return true;
     }
 };
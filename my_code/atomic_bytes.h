@@ -0,0 +1,89 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 按字节 relaxed 原子地读写一个可平凡复制的对象，供顺序锁（seqlock）风格的乐观读者使用：
+// 写者持有锁时用 atomic_store_bytes 写入乐观读者可能同时在读的数据，乐观读者用 atomic_load_bytes / atomic_load_copy 读出，
+// 读到的可能是新旧混合的字节（随后由版本号校验丢弃），但不构成数据竞争。
+// 每次读写的宽度是整除对象大小、且不超过对象对齐要求的最大整数（8/4/2/1 字节）：int、指针等类型只需一条普通的 mov，
+// 不能整除时退回逐字节。宽于 1 字节的读写通过 GCC 的 may_alias 类型访问对象的字节
+
+#ifndef CPP_CONCURRENCY_IN_ACTION_ATOMIC_BYTES_H
+#define CPP_CONCURRENCY_IN_ACTION_ATOMIC_BYTES_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace atomic_bytes_detail{
+    // 每次读写的宽度：整除 sizeof(T) 且不超过 alignof(T) 的最大的 8/4/2/1
+    template<class T>
+    constexpr std::size_t word_size = (alignof(T) >= 8 && sizeof(T) % 8 == 0) ? 8 :
+                                      (alignof(T) >= 4 && sizeof(T) % 4 == 0) ? 4 :
+                                      (alignof(T) >= 2 && sizeof(T) % 2 == 0) ? 2 : 1;
+
+    // may_alias 属性在作为模板实参传递时会被丢掉，因此放在特化的成员 typedef 中，使用处直接写 word<N>::type
+    template<std::size_t Size>
+    struct word{
+        typedef unsigned char type;
+    };
+#if defined(__GNUC__)
+    template<>
+    struct word<8>{
+        typedef std::uint64_t type __attribute__((may_alias));
+    };
+
+    template<>
+    struct word<4>{
+        typedef std::uint32_t type __attribute__((may_alias));
+    };
+
+    template<>
+    struct word<2>{
+        typedef std::uint16_t type __attribute__((may_alias));
+    };
+#endif
+}
+
+template<class T>
+void atomic_load_bytes(void *dst, const T *src){
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable objects can be copied byte by byte");
+    constexpr std::size_t n = atomic_bytes_detail::word_size<T>;
+    auto *d = static_cast<typename atomic_bytes_detail::word<n>::type*>(dst);
+    auto *p = reinterpret_cast<const typename atomic_bytes_detail::word<n>::type*>(src);
+    for(std::size_t i = 0; i < sizeof(T) / n; ++i){
+#if defined(__GNUC__)
+        d[i] = __atomic_load_n(p + i, __ATOMIC_RELAXED);
+#else
+        d[i] = std::atomic_ref<unsigned char>(const_cast<unsigned char&>(p[i])).load(std::memory_order_relaxed);
+#endif
+    }
+}
+
+template<class T>
+void atomic_store_bytes(T *dst, const T &src){
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable objects can be copied byte by byte");
+    constexpr std::size_t n = atomic_bytes_detail::word_size<T>;
+    auto *d = reinterpret_cast<typename atomic_bytes_detail::word<n>::type*>(dst);
+    auto *p = reinterpret_cast<const typename atomic_bytes_detail::word<n>::type*>(&src);
+    for(std::size_t i = 0; i < sizeof(T) / n; ++i){
+#if defined(__GNUC__)
+        __atomic_store_n(d + i, p[i], __ATOMIC_RELAXED);
+#else
+        std::atomic_ref<unsigned char>(d[i]).store(p[i], std::memory_order_relaxed);
+#endif
+    }
+}
+
+// 读出一个 T 的副本。先拷贝到按 T 对齐的字节数组中，再用 bit_cast 得到对象，T 不需要默认构造函数
+template<class T>
+T atomic_load_copy(const T *src){
+    struct alignas(T) bytes{
+        unsigned char data[sizeof(T)];
+    } buf;
+    atomic_load_bytes(buf.data, src);
+    return std::bit_cast<T>(buf);
+}
+
+#endif //CPP_CONCURRENCY_IN_ACTION_ATOMIC_BYTES_H
@@ -4,6 +4,11 @@
 
 // github上一个短小精悍的线程池实现
 // https://github.com/progschj/ThreadPool
+// 在原实现的基础上增加了弹性模式：线程数在 [min_threads, max_threads] 之间随负载伸缩
+// - 扩容：排队任务数超过空闲线程数 + max_queue_depth；最老的排队任务等待超过 max_queue_wait（由监控线程发现，
+//   也能发现没有声明的阻塞）；工作线程通过 blocking_guard 声明即将阻塞而队列中还有任务
+// - 缩容：空闲超过 keep_alive 的线程在线程数多于 min_threads 时退出
+// - 每一次扩缩容都计入 stats() 返回的计数器
 
 #ifndef CPP_CONCURRENCY_IN_ACTION_THREADPOOL_H
 #define CPP_CONCURRENCY_IN_ACTION_THREADPOOL_H
@@ -18,54 +23,359 @@
 #include <functional>
 #include <stdexcept>
 #include <type_traits>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "../9.7_threadpool_4/task_priority.h"
+#include "../9.7_threadpool_4/timer_wheel.h"
 
 class ThreadPool{
 public:
+    // 弹性模式的参数
+    struct ElasticConfig{
+        size_t min_threads = 1;
+        size_t max_threads = std::max(1u, std::thread::hardware_concurrency()) * 4;
+        size_t max_queue_depth = 0;                             // 排队任务数超过“空闲线程数 + 它”时扩容
+        std::chrono::milliseconds max_queue_wait{20};           // 最老的排队任务等待超过它时扩容
+        std::chrono::milliseconds keep_alive{1000};             // 多于 min_threads 的线程空闲超过它就退出
+    };
+
+    // 扩缩容计数器（同一时刻的快照）
+    struct Stats{
+        size_t threads;             // 当前线程数
+        size_t idle_threads;
+        size_t blocked_threads;     // 处于 blocking_guard 中的线程
+        size_t peak_threads;
+        size_t queued_tasks;
+        std::uint64_t threads_started;
+        std::uint64_t threads_retired;      // 因空闲超时退出
+        std::uint64_t grow_by_queue_depth;
+        std::uint64_t grow_by_queue_wait;
+        std::uint64_t grow_by_blocking;
+    };
+
+    // 工作线程在执行可能长时间阻塞的操作（例如阻塞 I/O）前构造，离开作用域时结束。
+    // 阻塞期间若队列中还有任务且没有空闲线程，弹性模式下立即补充一个线程
+    class blocking_guard{
+    public:
+        explicit blocking_guard(ThreadPool &pool_): pool(pool_){
+            pool.begin_blocking();
+        }
+        ~blocking_guard(){
+            pool.end_blocking();
+        }
+        blocking_guard(const blocking_guard&) = delete;
+        blocking_guard& operator=(const blocking_guard&) = delete;
+    private:
+        ThreadPool &pool;
+    };
+
+    // 固定线程数
     ThreadPool(size_t);
 
+    // 弹性模式：启动 min_threads 个线程，按负载在 [min_threads, max_threads] 之间伸缩；
+    // min_threads == max_threads 时等价于固定线程数
+    explicit ThreadPool(const ElasticConfig &config);
+
     // std::result_of 可以获取返回类型
     template<class F, class... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
 
+    // 按优先级提交，工作线程先取高优先级车道中的任务（低优先级车道通过老化避免饿死）
+    template<class F, class... Args>
+    auto enqueue(task_priority priority, F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
+
+    // 延迟任务：到期时由时间轮线程按 priority 放入任务队列
+    template<class Rep, class Period, class F, class... Args>
+    auto enqueue_after(std::chrono::duration<Rep, Period> delay, F&& f, Args&&... args)
+            -> std::future<typename std::result_of<F(Args...)>::type>;
+
+    template<class F, class... Args>
+    auto enqueue_at(std::chrono::steady_clock::time_point when, F&& f, Args&&... args)
+            -> std::future<typename std::result_of<F(Args...)>::type>;
+
+    // 周期任务：每隔 period 执行一次 f，直到 cancel_timer；上一次执行结束前不会开始下一次
+    template<class Rep, class Period, class F>
+    timer_id enqueue_every(std::chrono::duration<Rep, Period> period, F f);
+
+    bool cancel_timer(timer_id id){
+        return timers.cancel(id);
+    }
+
+    Stats stats();
+
     ~ThreadPool();
 private:
-    std::vector<std::thread> workers;       // 工作线程
-    std::queue<std::function<void()>> tasks;  // 任务队列
+    using clock = std::chrono::steady_clock;
+
+    struct queued_task{
+        std::function<void()> f;
+        clock::time_point enqueued;     // 用于计算排队等待时间
+    };
+
+    std::vector<std::thread> workers;       // 工作线程（包括已经退出、尚未 join 的线程）
+    std::vector<std::thread::id> exited;    // 已经因空闲超时退出的线程，下次扩容或析构时 join
+    std::queue<queued_task> tasks[priority_lane_count];  // 任务队列，每条优先级车道一个
+    priority_aging aging;                   // 所有工作线程共享，只在持有 queue_mutex 时使用
 
     // 同步
     std::mutex queue_mutex;
     std::condition_variable condition;
     bool stop;
+
+    // 弹性模式的状态，除 elastic 和 config 外都由 queue_mutex 保护
+    ElasticConfig config;
+    bool const elastic;             // max_threads > min_threads
+    size_t live_threads = 0;        // 包括已经预定、正在创建的线程
+    size_t starting_threads = 0;    // 已经预定、还没有放入 workers 的线程
+    size_t idle_threads = 0;
+    size_t blocked_threads = 0;
+    size_t queued_count = 0;
+    Stats counters{};
+    std::condition_variable monitor_condition;
+    std::thread monitor;
+
+    timer_wheel timers;     // 析构函数中最先停止，之后不会再有到期任务入队
+
+    enum class grow_reason{ queue_depth, queue_wait, blocking };
+
+    bool has_task() const{
+        return queued_count != 0;
+    }
+
+    void push_task(unsigned lane, std::function<void()> f);
+    void worker_loop();
+    void monitor_loop();
+    void begin_blocking();
+    void end_blocking();
+    // 需要持有锁：预定一个新线程，返回 false 表示已达上限或正在析构
+    bool reserve_thread_locked(grow_reason reason);
+    void start_thread();
+    void reap_exited_locked(std::vector<std::thread> &to_join);
 };
 
 // 在构造函数中将工作线程启动
-inline ThreadPool::ThreadPool(size_t thread_num): stop(false) {
-    for(size_t i = 0; i < thread_num; ++i){
-        workers.emplace_back([this](){
-            // 每个工作线程无线循环，不断接任务。
-            for(;;){
-                std::function<void()> task;
-
-                {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    condition.wait(lock, [this](){
-                        return this->stop || !this->tasks.empty();
-                    });
-                    if(stop && tasks.empty())
-                        return;
-                    task = std::move(tasks.front());
-                    tasks.pop();
-                }// lock.unlock()
-
-                task();
+inline ThreadPool::ThreadPool(size_t thread_num): ThreadPool(ElasticConfig{thread_num, thread_num}) {
+}
+
+inline ThreadPool::ThreadPool(const ElasticConfig &config_): stop(false),
+        config{config_.min_threads, std::max(config_.max_threads, config_.min_threads), config_.max_queue_depth,
+               config_.max_queue_wait, config_.keep_alive},
+        elastic(config.max_threads > config.min_threads),
+        timers([this](function_wrapper task, task_priority priority){
+            // std::function 要求可拷贝，只可移动的任务放在 shared_ptr 中
+            auto shared_task = std::make_shared<function_wrapper>(std::move(task));
+            push_task(lane_of(priority), [shared_task](){
+                (*shared_task)();
+            });
+        }) {
+    for(size_t i = 0; i < config.min_threads; ++i){
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            ++live_threads;
+            ++starting_threads;
+        }
+        start_thread();
+    }
+    if(elastic){
+        monitor = std::thread(&ThreadPool::monitor_loop, this);
+    }
+}
+
+inline void ThreadPool::start_thread(){
+    std::thread t;
+    try{
+        t = std::thread(&ThreadPool::worker_loop, this);
+    }catch (...){
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        --live_threads;
+        --starting_threads;
+        throw;
+    }
+    std::vector<std::thread> to_join;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        workers.push_back(std::move(t));
+        --starting_threads;
+        ++counters.threads_started;
+        counters.peak_threads = std::max(counters.peak_threads, live_threads);
+        reap_exited_locked(to_join);
+    }
+    for(auto &worker: to_join){
+        worker.join();
+    }
+}
+
+inline void ThreadPool::reap_exited_locked(std::vector<std::thread> &to_join){
+    for(auto id: exited){
+        auto it = std::find_if(workers.begin(), workers.end(), [id](const std::thread &t){ return t.get_id() == id; });
+        if(it != workers.end()){
+            to_join.push_back(std::move(*it));
+            workers.erase(it);
+        }
+    }
+    exited.clear();
+}
+
+inline bool ThreadPool::reserve_thread_locked(grow_reason reason){
+    if(stop || live_threads >= config.max_threads){
+        return false;
+    }
+    ++live_threads;
+    ++starting_threads;
+    switch(reason){
+        case grow_reason::queue_depth: ++counters.grow_by_queue_depth; break;
+        case grow_reason::queue_wait: ++counters.grow_by_queue_wait; break;
+        case grow_reason::blocking: ++counters.grow_by_blocking; break;
+    }
+    return true;
+}
+
+inline void ThreadPool::push_task(unsigned lane, std::function<void()> f){
+    bool grow = false;
+    bool wake_monitor = false;
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+
+        // stop=true 时不允许再提交任务（pool正在析构）
+        if(stop){
+            throw std::runtime_error("enqueue on stopped ThreadPool.");
+        }
+        tasks[lane].push(queued_task{std::move(f), clock::now()});
+        ++queued_count;
+        if(elastic && queued_count > idle_threads + config.max_queue_depth){
+            grow = reserve_thread_locked(grow_reason::queue_depth);
+        }
+        wake_monitor = elastic && idle_threads == 0;
+    }// lock.unlock();
+
+    condition.notify_one();
+    if(wake_monitor){
+        monitor_condition.notify_one();
+    }
+    if(grow){
+        start_thread();
+    }
+}
+
+inline void ThreadPool::worker_loop(){
+    // 每个工作线程无线循环，不断接任务。
+    for(;;){
+        std::function<void()> task;
+        bool wake_monitor = false;
+
+        {
+            std::unique_lock<std::mutex> lock(this->queue_mutex);
+            ++idle_threads;
+            while(!stop && !has_task()){
+                if(live_threads <= config.min_threads){
+                    condition.wait(lock);
+                }else if(condition.wait_for(lock, config.keep_alive) == std::cv_status::timeout
+                         && !stop && !has_task() && live_threads > config.min_threads){
+                    // 空闲超时，退出（由其它线程 join）
+                    --idle_threads;
+                    --live_threads;
+                    ++counters.threads_retired;
+                    exited.push_back(std::this_thread::get_id());
+                    return;
+                }
+            }
+            --idle_threads;
+            if(stop && !has_task()){
+                --live_threads;
+                return;
+            }
+            aging.for_each_lane([&](unsigned lane){
+                if(tasks[lane].empty()){
+                    return false;
+                }
+                task = std::move(tasks[lane].front().f);
+                tasks[lane].pop();
+                return true;
+            });
+            --queued_count;
+            // 最后一个空闲线程也开始忙碌而队列中仍有任务，让监控线程开始计时
+            wake_monitor = elastic && queued_count != 0 && idle_threads == 0;
+        }// lock.unlock()
+
+        if(wake_monitor){
+            monitor_condition.notify_one();
+        }
+        task();
+    }
+}
+
+// 监控线程：有任务排队且没有空闲线程时，睡到最老任务的等待时间达到 max_queue_wait，仍然如此就扩容。
+// 工作线程全部阻塞在没有声明的操作上时，也靠它补充线程。队列为空时一直睡眠，不会轮询
+inline void ThreadPool::monitor_loop(){
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    while(!stop){
+        monitor_condition.wait(lock, [this](){
+            return stop || (has_task() && idle_threads == 0);
+        });
+        if(stop){
+            break;
+        }
+        clock::time_point oldest = clock::time_point::max();
+        for(auto &lane: tasks){
+            if(!lane.empty()){
+                oldest = std::min(oldest, lane.front().enqueued);
             }
+        }
+        if(clock::now() - oldest < config.max_queue_wait){
+            monitor_condition.wait_until(lock, oldest + config.max_queue_wait);
+            continue;
+        }
+        if(reserve_thread_locked(grow_reason::queue_wait)){
+            lock.unlock();
+            start_thread();
+            lock.lock();
+        }
+        // 新线程需要时间取走积压的任务（或者已达上限），至少等待一个周期再检查，避免连续扩容
+        auto const next_check = clock::now() + config.max_queue_wait;
+        monitor_condition.wait_until(lock, next_check, [&](){
+            return stop || clock::now() >= next_check;
         });
     }
 }
 
+inline void ThreadPool::begin_blocking(){
+    bool grow = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        ++blocked_threads;
+        if(elastic && queued_count > idle_threads){
+            grow = reserve_thread_locked(grow_reason::blocking);
+        }
+    }
+    if(grow){
+        start_thread();
+    }
+}
+
+inline void ThreadPool::end_blocking(){
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    --blocked_threads;
+}
+
+inline ThreadPool::Stats ThreadPool::stats(){
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    Stats res = counters;
+    res.threads = live_threads;
+    res.idle_threads = idle_threads;
+    res.blocked_threads = blocked_threads;
+    res.queued_tasks = queued_count;
+    return res;
+}
+
 // 向任务队列提交任务
 template<class F, class... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>{
+    return enqueue(task_priority::normal, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<class F, class... Args>
+auto ThreadPool::enqueue(task_priority priority, F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>{
     using return_type = typename std::result_of<F(Args...)>::type;
 
     auto task = std::make_shared< std::packaged_task<return_type()> >(
@@ -74,33 +384,50 @@ auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::res
 
     std::future<return_type> res = task->get_future();
 
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+    /*
+         std::queue<queued_task> tasks
+         向其添加一个用 void() 包装的函数：
+         void wrapper(){
+            // task是一个packaged_task指针
+            // 可以带任意返回类型，任意参数
+            (*task)();
+         }
+     */
+    push_task(lane_of(priority), [task](){
+        (*task)();
+    });
+    return res;
+}
 
-        // stop=true 时不允许再提交任务（pool正在析构）
-        if(stop){
-            throw std::runtime_error("enqueue on stopped ThreadPool.");
-        }
+template<class Rep, class Period, class F, class... Args>
+auto ThreadPool::enqueue_after(std::chrono::duration<Rep, Period> delay, F&& f, Args&&... args)
+        -> std::future<typename std::result_of<F(Args...)>::type>{
+    return enqueue_at(std::chrono::steady_clock::now() + delay, std::forward<F>(f), std::forward<Args>(args)...);
+}
 
-        /*
-             std::queue<std::function<void()>> tasks
-             向其添加一个用 void() 包装的函数：
-             void wrapper(){
-                // task是一个packaged_task指针
-                // 可以带任意返回类型，任意参数
-                (*task)();
-             }
-         */
-        tasks.emplace([task](){
-            (*task)();
-        });
-    }// lock.unlock();
+template<class F, class... Args>
+auto ThreadPool::enqueue_at(std::chrono::steady_clock::time_point when, F&& f, Args&&... args)
+        -> std::future<typename std::result_of<F(Args...)>::type>{
+    using return_type = typename std::result_of<F(Args...)>::type;
 
-    condition.notify_one();
+    auto task = std::make_shared< std::packaged_task<return_type()> >(
+                std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+            );
+    std::future<return_type> res = task->get_future();
+    timers.schedule_at(when, [task](){
+        (*task)();
+    });
     return res;
 }
 
+template<class Rep, class Period, class F>
+timer_id ThreadPool::enqueue_every(std::chrono::duration<Rep, Period> period, F f){
+    auto const p = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    return timers.schedule_every(std::chrono::steady_clock::now() + p, p, std::move(f));
+}
+
 inline ThreadPool::~ThreadPool() {
+    timers.stop();
     {
         std::unique_lock<std::mutex> lock(queue_mutex);
         stop = true;
@@ -109,9 +436,28 @@ inline ThreadPool::~ThreadPool() {
     // 1. stop = true
     // 2. 唤醒所有等待线程，催促它们把队列中的所有任务完成，随后所有线程结束
     condition.notify_all();
+    monitor_condition.notify_all();
+    if(monitor.joinable()){
+        monitor.join();
+    }
 
-    for(auto &worker: workers){
-        worker.join();
+    // 排空队列时仍可能有线程正在被创建（blocking_guard 触发），直到所有线程都退出
+    for(;;){
+        std::vector<std::thread> to_join;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            to_join.swap(workers);
+            exited.clear();
+            if(to_join.empty() && live_threads == 0 && starting_threads == 0){
+                break;
+            }
+        }
+        for(auto &worker: to_join){
+            worker.join();
+        }
+        if(to_join.empty()){
+            std::this_thread::yield();
+        }
     }
 }
 
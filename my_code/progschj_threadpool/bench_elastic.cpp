@@ -0,0 +1,100 @@
+//
+// Created by chen on 2026/10/18.
+//
+// 弹性线程池示例：
+// 1. 大量模拟阻塞 I/O 的任务（sleep 10ms）：固定 2 个线程与弹性 [2, 32] 线程的总耗时，以及各扩容原因的次数
+// 2. 负载消失后，多余的线程在 keep_alive 之后退出，线程数回落到 min_threads
+// 3. 没有用 blocking_guard 声明的阻塞也会被监控线程通过排队等待时间发现
+
+#include "ThreadPool.h"
+#include <iostream>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+void print_stats(ThreadPool::Stats const &s){
+    std::cout << "  threads " << s.threads << " (peak " << s.peak_threads << ", started " << s.threads_started
+              << ", retired " << s.threads_retired << "), grow by depth/wait/blocking "
+              << s.grow_by_queue_depth << "/" << s.grow_by_queue_wait << "/" << s.grow_by_blocking << std::endl;
+}
+
+long long run_blocking_tasks(ThreadPool &pool, int count, bool declare_blocking){
+    auto const start = bench_clock::now();
+    std::vector<std::future<int>> results;
+    for(int i = 0; i < count; ++i){
+        results.emplace_back(pool.enqueue([&pool, declare_blocking, i]{
+            if(declare_blocking){
+                ThreadPool::blocking_guard guard(pool);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }else{
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return i;
+        }));
+    }
+    long long sum = 0;
+    for(auto &r: results){
+        sum += r.get();
+    }
+    if(sum != static_cast<long long>(count) * (count - 1) / 2){
+        return -1;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - start).count();
+}
+
+int main(){
+    int const count = 200;
+    bool ok = true;
+
+    {
+        ThreadPool fixed(2);
+        long long const ms = run_blocking_tasks(fixed, count, true);
+        ok = ok && ms >= 0;
+        std::cout << "fixed 2 threads, " << count << " x 10ms blocking tasks: " << ms << " ms" << std::endl;
+        print_stats(fixed.stats());
+    }
+
+    ThreadPool::ElasticConfig config;
+    config.min_threads = 2;
+    config.max_threads = 32;
+    config.max_queue_depth = 64;    // 突发提交不立即扩容，靠阻塞声明和排队等待时间扩容
+    config.max_queue_wait = std::chrono::milliseconds(20);
+    config.keep_alive = std::chrono::milliseconds(200);
+    ThreadPool pool(config);
+
+    long long const ms = run_blocking_tasks(pool, count, true);
+    ThreadPool::Stats s = pool.stats();
+    bool const grow_ok = ms >= 0 && s.peak_threads > 2 && s.peak_threads <= 32 && s.grow_by_blocking > 0;
+    ok = ok && grow_ok;
+    std::cout << "elastic [2, 32], declared blocking: " << ms << " ms" << (grow_ok ? "  check." : "  MISMATCH") << std::endl;
+    print_stats(s);
+
+    // 等待 keep_alive 过去，多余线程退出
+    auto const idle_start = bench_clock::now();
+    while(pool.stats().threads > config.min_threads && bench_clock::now() - idle_start < std::chrono::seconds(5)){
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    s = pool.stats();
+    bool const retire_ok = s.threads == config.min_threads && s.threads_retired == s.threads_started - config.min_threads;
+    ok = ok && retire_ok;
+    std::cout << "after " << std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - idle_start).count()
+              << " ms idle" << (retire_ok ? "  check." : "  MISMATCH") << std::endl;
+    print_stats(s);
+
+    // 没有声明的阻塞：只能由监控线程根据排队等待时间扩容
+    long long const undeclared_ms = run_blocking_tasks(pool, 60, false);    // 不超过 max_queue_depth
+    auto const before = s;
+    s = pool.stats();
+    bool const wait_ok = undeclared_ms >= 0 && s.grow_by_queue_wait > before.grow_by_queue_wait;
+    ok = ok && wait_ok;
+    std::cout << "elastic [2, 32], 60 tasks with undeclared blocking: " << undeclared_ms << " ms"
+              << (wait_ok ? "  check." : "  MISMATCH") << std::endl;
+    print_stats(s);
+
+    // 周期任务与延迟任务依然经过同一个入队路径
+    std::future<int> delayed = pool.enqueue_after(std::chrono::milliseconds(5), []{ return 42; });
+    bool const delayed_ok = delayed.get() == 42;
+    ok = ok && delayed_ok;
+    std::cout << "delayed task" << (delayed_ok ? "  check." : "  MISMATCH") << std::endl;
+    return ok ? 0 : 1;
+}